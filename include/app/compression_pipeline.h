@@ -0,0 +1,301 @@
+#ifndef COMPRESSION_PIPELINE_H
+#define COMPRESSION_PIPELINE_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include "inventory.h"
+#include "inventory_compressor.h"
+
+// -------------------- BoundedQueue --------------------
+// Hàng đợi FIFO có sức chứa cố định (bộ đệm vòng) dùng giữa các tầng của pipeline.
+// push chặn khi đầy (áp lực ngược), pop chặn khi rỗng; sau close, push bị từ chối
+// và pop trả về false khi đã lấy hết phần tử còn lại
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(int capacity);
+    ~BoundedQueue();
+
+    bool push(const T &item);
+    bool pop(T &item);
+    void close();
+    int size();
+    int capacity() const { return cap; }
+
+private:
+    T *items;
+    int cap;
+    int head;
+    int count;
+    bool closed;
+    std::mutex mtx;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+};
+
+// -------------------- CompressionPipeline --------------------
+// Nén toàn bộ kho hàng theo bốn tầng chạy trên bốn luồng riêng:
+//   trích xuất (tên, thuộc tính) -> tuần tự hoá (productToString) -> mã hoá -> ghi ra luồng xuất
+// Các tầng nối với nhau bằng BoundedQueue nên bộ nhớ bị chặn bởi queueCapacity bản ghi mỗi hàng đợi.
+// Mỗi sản phẩm được ghi thành một dòng mã Huffman theo đúng thứ tự trong kho, giải mã lại bằng
+// decodeHuffman. Kho hàng và mô hình không được thay đổi trong khi pipeline đang chạy
+template <int treeOrder>
+class CompressionPipeline
+{
+public:
+    struct Stats
+    {
+        int records;
+        long rawBytes;     // tổng độ dài chuỗi sản phẩm
+        long encodedBytes; // tổng số chữ số Huffman đã ghi (không tính ký tự xuống dòng)
+    };
+
+    static constexpr int DEFAULT_QUEUE_CAPACITY = 64;
+
+    CompressionPipeline(InventoryManager *manager, InventoryCompressor<treeOrder> *compressor,
+                        int queueCapacity = DEFAULT_QUEUE_CAPACITY);
+
+    Stats run(std::ostream &out);
+    bool runToFile(const std::string &path, Stats &stats);
+
+private:
+    InventoryManager *invManager;
+    InventoryCompressor<treeOrder> *compressor;
+    int queueCapacity;
+
+    struct ProductRecord
+    {
+        std::string name;
+        List1D<InventoryAttribute> attributes;
+    };
+};
+
+///////////////////////////// Triển khai BoundedQueue ////////////////////////
+template <typename T>
+BoundedQueue<T>::BoundedQueue(int capacity) : head(0), count(0), closed(false)
+{
+    if (capacity <= 0)
+    {
+        throw std::invalid_argument("Queue capacity must be positive");
+    }
+    cap = capacity;
+    items = new T[capacity];
+}
+
+template <typename T>
+BoundedQueue<T>::~BoundedQueue()
+{
+    delete[] items;
+}
+
+template <typename T>
+bool BoundedQueue<T>::push(const T &item)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    notFull.wait(lock, [this]()
+                 { return count < cap || closed; });
+    if (closed)
+    {
+        return false;
+    }
+    items[(head + count) % cap] = item;
+    count++;
+    notEmpty.notify_one();
+    return true;
+}
+
+template <typename T>
+bool BoundedQueue<T>::pop(T &item)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    notEmpty.wait(lock, [this]()
+                  { return count > 0 || closed; });
+    if (count == 0)
+    {
+        return false;
+    }
+    item = items[head];
+    items[head] = T();
+    head = (head + 1) % cap;
+    count--;
+    notFull.notify_one();
+    return true;
+}
+
+template <typename T>
+void BoundedQueue<T>::close()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    closed = true;
+    notFull.notify_all();
+    notEmpty.notify_all();
+}
+
+template <typename T>
+int BoundedQueue<T>::size()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return count;
+}
+
+///////////////////////////// Triển khai CompressionPipeline ////////////////////////
+template <int treeOrder>
+CompressionPipeline<treeOrder>::CompressionPipeline(InventoryManager *manager,
+                                                    InventoryCompressor<treeOrder> *compressor,
+                                                    int queueCapacity)
+{
+    if (manager == nullptr || compressor == nullptr)
+    {
+        throw std::invalid_argument("Pipeline requires an inventory and a compressor");
+    }
+    if (queueCapacity <= 0)
+    {
+        throw std::invalid_argument("Queue capacity must be positive");
+    }
+    this->invManager = manager;
+    this->compressor = compressor;
+    this->queueCapacity = queueCapacity;
+}
+
+// Chạy cả bốn tầng và chờ tất cả kết thúc. Lỗi ở một tầng đóng mọi hàng đợi để các tầng khác
+// dừng sớm, sau đó được ném lại ở luồng gọi
+template <int treeOrder>
+typename CompressionPipeline<treeOrder>::Stats CompressionPipeline<treeOrder>::run(std::ostream &out)
+{
+    BoundedQueue<ProductRecord> extracted(queueCapacity);
+    BoundedQueue<std::string> serialized(queueCapacity);
+    BoundedQueue<std::string> encoded(queueCapacity);
+
+    Stats stats = {0, 0, 0};
+    std::exception_ptr failure = nullptr;
+    std::mutex failureMutex;
+    auto fail = [&]()
+    {
+        {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (failure == nullptr)
+            {
+                failure = std::current_exception();
+            }
+        }
+        extracted.close();
+        serialized.close();
+        encoded.close();
+    };
+
+    std::thread extractStage([&]()
+                             {
+        try
+        {
+            int n = invManager->size();
+            for (int i = 0; i < n; i++)
+            {
+                ProductRecord record;
+                record.name = invManager->getProductName(i);
+                record.attributes = invManager->getProductAttributes(i);
+                if (!extracted.push(record))
+                {
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+        extracted.close(); });
+
+    std::thread serializeStage([&]()
+                               {
+        try
+        {
+            ProductRecord record;
+            while (extracted.pop(record))
+            {
+                std::string productStr = compressor->productToString(record.attributes, record.name);
+                stats.rawBytes += (long)productStr.length();
+                if (!serialized.push(productStr))
+                {
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+        serialized.close(); });
+
+    std::thread encodeStage([&]()
+                            {
+        try
+        {
+            std::string productStr;
+            while (serialized.pop(productStr))
+            {
+                if (!encoded.push(compressor->encodeProductString(productStr)))
+                {
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+        encoded.close(); });
+
+    // Tầng ghi chạy trên luồng gọi
+    try
+    {
+        std::string code;
+        while (encoded.pop(code))
+        {
+            out << code << '\n';
+            if (!out)
+            {
+                throw std::runtime_error("Failed to write compressed output");
+            }
+            stats.records++;
+            stats.encodedBytes += (long)code.length();
+        }
+    }
+    catch (...)
+    {
+        fail();
+    }
+
+    extractStage.join();
+    serializeStage.join();
+    encodeStage.join();
+    if (failure != nullptr)
+    {
+        std::rethrow_exception(failure);
+    }
+    return stats;
+}
+
+template <int treeOrder>
+bool CompressionPipeline<treeOrder>::runToFile(const std::string &path, Stats &stats)
+{
+    std::ofstream file(path.c_str(), std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    stats = run(file);
+    file.flush();
+    return (bool)file;
+}
+
+#endif // COMPRESSION_PIPELINE_H
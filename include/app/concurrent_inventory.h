@@ -0,0 +1,628 @@
+#ifndef CONCURRENT_INVENTORY_H
+#define CONCURRENT_INVENTORY_H
+
+#include <string>
+#include <stdexcept>
+#include <mutex>
+#include <shared_mutex>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include "inventory.h"
+#include "heap/Heap.h"
+
+// -------------------- ConcurrentInventoryManager --------------------
+// Kho hàng dùng chung giữa nhiều luồng. Các sản phẩm được chia theo chỉ số thành các phân đoạn liên tiếp,
+// mỗi phân đoạn là một InventoryManager (lưu dạng thường) có khoá đọc-ghi riêng và chỉ số đầu (start).
+// Bảng phân đoạn được công bố qua con trỏ nguyên tử; luồng đọc không lấy khoá chung nào:
+//   - size: đọc bộ đếm nguyên tử;
+//   - getProduct*, updateQuantity: tìm nhị phân trên bảng rồi chỉ khoá (đọc/ghi) đúng phân đoạn tìm được,
+//     kiểm tra lại start và kích thước dưới khoá đó, thử lại nếu bảng vừa đổi;
+//   - query, toInventory: khoá đọc mọi phân đoạn của bảng rồi kiểm tra chúng phủ liên tục [0, size) nên
+//     kết quả là một trạng thái nhất quán;
+//   - addProduct/removeProduct: tuần tự hoá với nhau bằng khoá ghi cấu trúc (luồng đọc không chạm tới),
+//     giữ khoá ghi của mọi phân đoạn có start hoặc nội dung thay đổi trong suốt thao tác.
+// removeProduct gộp phân đoạn vừa xoá với một phân đoạn kề khi tổng kích thước không vượt shardCapacity,
+// nên hai phân đoạn kề nhau luôn chứa hơn shardCapacity sản phẩm (số phân đoạn <= 2n/shardCapacity + 1).
+// Phân đoạn rỗng được tái sử dụng, bảng cũ (khi bảng phải nới rộng) được giữ tới khi huỷ kho nên luồng
+// đọc đang dùng bảng cũ không bao giờ chạm vào vùng nhớ đã giải phóng.
+// Chỉ removeProduct chờ khoá khi đang giữ khoá phân đoạn khác, và luôn theo thứ tự id phân đoạn; mọi luồng
+// khác chỉ chờ khi tay trắng (query thử các khoá còn lại rồi trả hết nếu hụt) nên không có vòng chờ
+class ConcurrentInventoryManager
+{
+public:
+    static constexpr int DEFAULT_SHARD_CAPACITY = 4096;
+
+    explicit ConcurrentInventoryManager(int shardCapacity = DEFAULT_SHARD_CAPACITY);
+    explicit ConcurrentInventoryManager(const InventoryManager &inventory,
+                                        int shardCapacity = DEFAULT_SHARD_CAPACITY);
+    ~ConcurrentInventoryManager();
+
+    int size() const;
+    int shardCount() const;
+    List1D<InventoryAttribute> getProductAttributes(int index) const;
+    std::string getProductName(int index) const;
+    int getProductQuantity(int index) const;
+    void updateQuantity(int index, int newQuantity);
+    void addProduct(const List1D<InventoryAttribute> &attributes, const std::string &name, int quantity);
+    void removeProduct(int index);
+
+    // Cùng ngữ nghĩa với InventoryManager::query: mỗi phân đoạn trả về danh sách đã sắp xếp, các danh sách
+    // được trộn k đường bằng một Heap
+    List1D<std::string> query(const std::string &attributeName, const double &minValue,
+                              const double &maxValue, int minQuantity, bool ascending) const;
+
+    // Bản sao thường (một InventoryManager) của toàn bộ kho tại một thời điểm, O(n)
+    InventoryManager toInventory() const;
+
+private:
+    struct Shard
+    {
+        InventoryManager inventory;
+        std::atomic<int> start; // chỉ đổi khi giữ khoá ghi của phân đoạn
+        int id;                 // số thứ tự cấp phát, cố định suốt đời phân đoạn
+        mutable std::shared_mutex lock;
+        explicit Shard(int id) : start(0), id(id) {}
+    };
+
+    // Bảng phân đoạn: slots[0, shardTotal) theo thứ tự chỉ số. Chỉ luồng ghi cấu trúc sửa các ô; khi hết
+    // chỗ, một bảng gấp đôi được công bố thay thế
+    struct ShardDirectory
+    {
+        int capacity;
+        std::unique_ptr<std::atomic<Shard *>[]> slots;
+        explicit ShardDirectory(int capacity) : capacity(capacity), slots(new std::atomic<Shard *>[capacity])
+        {
+            for (int s = 0; s < capacity; s++)
+            {
+                slots[s].store(nullptr);
+            }
+        }
+    };
+
+    // Chụp bảng phân đoạn và giữ khoá đọc của mọi phân đoạn trong đó cho tới release hoặc khi bị huỷ.
+    // Các phân đoạn giữ được luôn phủ liên tục [0, size) theo thứ tự chỉ số
+    class ShardReadGuard
+    {
+    public:
+        explicit ShardReadGuard(const ConcurrentInventoryManager &owner);
+        ~ShardReadGuard() { release(); }
+        void release();
+        int size() const { return total; }
+        Shard *get(int k) const { return view[k]; }
+
+    private:
+        std::unique_ptr<Shard *[]> view;
+        int total;
+        bool locked;
+        bool snapshot(const ConcurrentInventoryManager &owner);
+        void lockAll();
+        void unlockAll(int upTo, int skip);
+        bool covers(const ConcurrentInventoryManager &owner) const;
+    };
+
+    // Con trỏ tới dòng kết quả đang xét của một phân đoạn khi trộn k đường
+    struct MergeCursor
+    {
+        std::string name;
+        int shard;
+        int position;
+
+        // Heap yêu cầu so sánh và in phần tử (thứ tự thật do cursorAscending/cursorDescending quyết định)
+        bool operator==(const MergeCursor &other) const { return shard == other.shard && position == other.position; }
+        bool operator<(const MergeCursor &other) const { return name < other.name; }
+        bool operator>(const MergeCursor &other) const { return other < *this; }
+        friend std::ostream &operator<<(std::ostream &os, const MergeCursor &cursor) { return os << cursor.name; }
+    };
+
+    int shardCapacity;
+    std::atomic<int> count;
+    std::atomic<int> shardTotal;
+    std::atomic<int> allocatedShards;
+    std::atomic<ShardDirectory *> directory;
+    // Khoá ghi cấu trúc (addProduct/removeProduct) và các danh sách chỉ luồng giữ nó được chạm tới
+    std::mutex structure;
+    XArrayList<Shard *> allShards;  // mọi phân đoạn đã cấp phát, allShards[id]
+    XArrayList<Shard *> freeShards; // phân đoạn rỗng chờ tái sử dụng
+    XArrayList<ShardDirectory *> directories;
+
+    // Vị trí trong bảng của phân đoạn cuối cùng có start <= index (bảng có thể đang đổi: nơi gọi tự kiểm tra)
+    static int findSlot(const ShardDirectory *table, int total, int index);
+    // Khoá phân đoạn chứa sản phẩm index theo kiểu của guard (ném out_of_range nếu index sai);
+    // local nhận chỉ số trong phân đoạn
+    template <typename Lock>
+    Shard *lockProduct(int index, int &local, Lock &guard) const;
+    Shard *slotAt(int s) const { return directory.load()->slots[s].load(); }
+    Shard *spareShard();
+    void appendSlot(Shard *shard);
+    void removeSlot(int s);
+    void mergeAfterRemove(int s);
+
+    static int cursorAscending(MergeCursor &lhs, MergeCursor &rhs) { return lhs.name.compare(rhs.name); }
+    static int cursorDescending(MergeCursor &lhs, MergeCursor &rhs) { return rhs.name.compare(lhs.name); }
+
+    ConcurrentInventoryManager(const ConcurrentInventoryManager &) = delete;
+    ConcurrentInventoryManager &operator=(const ConcurrentInventoryManager &) = delete;
+};
+
+///////////////////////////// Triển khai ConcurrentInventoryManager ////////////////////////
+inline ConcurrentInventoryManager::ConcurrentInventoryManager(int shardCapacity)
+    : count(0), shardTotal(0), allocatedShards(0), directory(nullptr)
+{
+    if (shardCapacity <= 0)
+    {
+        throw std::invalid_argument("Shard capacity must be positive");
+    }
+    this->shardCapacity = shardCapacity;
+    ShardDirectory *table = new ShardDirectory(4);
+    directories.add(table);
+    directory.store(table);
+}
+
+inline ConcurrentInventoryManager::ConcurrentInventoryManager(const InventoryManager &inventory,
+                                                              int shardCapacity)
+    : ConcurrentInventoryManager(shardCapacity)
+{
+    // Nạp từng phân đoạn bằng addProducts, mỗi phân đoạn đầy trừ phân đoạn cuối
+    int n = inventory.size();
+    for (int begin = 0; begin < n; begin += shardCapacity)
+    {
+        int end = begin + shardCapacity < n ? begin + shardCapacity : n;
+        List2D<InventoryAttribute> attributes;
+        List1D<std::string> names;
+        List1D<int> quantities;
+        for (int i = begin; i < end; i++)
+        {
+            attributes.addRow(new List1D<InventoryAttribute>(inventory.getProductAttributes(i)));
+            names.add(inventory.getProductName(i));
+            quantities.add(inventory.getProductQuantity(i));
+        }
+        Shard *shard = spareShard();
+        shard->inventory.addProducts(attributes, names, quantities);
+        shard->start.store(begin);
+        freeShards.removeAt(freeShards.size() - 1);
+        appendSlot(shard);
+    }
+    count.store(n);
+}
+
+inline ConcurrentInventoryManager::~ConcurrentInventoryManager()
+{
+    for (int s = 0; s < allShards.size(); s++)
+    {
+        delete allShards.get(s);
+    }
+    for (int d = 0; d < directories.size(); d++)
+    {
+        delete directories.get(d);
+    }
+}
+
+inline int ConcurrentInventoryManager::findSlot(const ShardDirectory *table, int total, int index)
+{
+    if (total > table->capacity)
+    {
+        total = table->capacity;
+    }
+    // Tìm nhị phân ô cuối cùng có start <= index
+    int low = 0;
+    int high = total - 1;
+    while (low < high)
+    {
+        int mid = (low + high + 1) / 2;
+        Shard *shard = table->slots[mid].load();
+        if (shard != nullptr && shard->start.load() <= index)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    return low;
+}
+
+template <typename Lock>
+inline ConcurrentInventoryManager::Shard *ConcurrentInventoryManager::lockProduct(int index, int &local,
+                                                                                   Lock &guard) const
+{
+    while (true)
+    {
+        if (index < 0 || index >= count.load())
+        {
+            throw std::out_of_range("Index is invalid!");
+        }
+        // Đọc shardTotal trước bảng: bảng mới được công bố trước khi shardTotal tăng
+        int total = shardTotal.load();
+        const ShardDirectory *table = directory.load();
+        Shard *shard = total > 0 ? table->slots[findSlot(table, total, index)].load() : nullptr;
+        if (shard != nullptr)
+        {
+            guard = Lock(shard->lock);
+            local = index - shard->start.load();
+            if (local >= 0 && local < shard->inventory.size())
+            {
+                return shard;
+            }
+            guard.unlock();
+        }
+        // Bảng vừa đổi giữa lúc tìm và lúc khoá: đọc lại
+        std::this_thread::yield();
+    }
+}
+
+// Phân đoạn rỗng để nhận sản phẩm: lấy từ danh sách tái sử dụng (cấp mới nếu trống). Phân đoạn vẫn nằm
+// trong freeShards cho tới khi nơi gọi gỡ nó ra, để không bị mất nếu việc thêm sản phẩm ném ngoại lệ
+inline ConcurrentInventoryManager::Shard *ConcurrentInventoryManager::spareShard()
+{
+    if (freeShards.size() == 0)
+    {
+        Shard *shard = new Shard(allShards.size());
+        allShards.add(shard);
+        freeShards.add(shard);
+        allocatedShards.store(allShards.size());
+    }
+    return freeShards.get(freeShards.size() - 1);
+}
+
+inline void ConcurrentInventoryManager::appendSlot(Shard *shard)
+{
+    int total = shardTotal.load();
+    ShardDirectory *table = directory.load();
+    if (total == table->capacity)
+    {
+        ShardDirectory *grown = new ShardDirectory(table->capacity * 2);
+        directories.add(grown);
+        for (int s = 0; s < total; s++)
+        {
+            grown->slots[s].store(table->slots[s].load());
+        }
+        directory.store(grown);
+        table = grown;
+    }
+    table->slots[total].store(shard);
+    shardTotal.store(total + 1);
+}
+
+inline void ConcurrentInventoryManager::removeSlot(int s)
+{
+    int total = shardTotal.load();
+    ShardDirectory *table = directory.load();
+    Shard *removed = table->slots[s].load();
+    for (int t = s; t + 1 < total; t++)
+    {
+        table->slots[t].store(table->slots[t + 1].load());
+    }
+    shardTotal.store(total - 1);
+    removed->inventory = InventoryManager();
+    freeShards.add(removed);
+}
+
+// Gộp phân đoạn s (vừa bị xoá một sản phẩm) với phân đoạn kề nếu tổng kích thước không vượt shardCapacity.
+// Nơi gọi giữ khoá cấu trúc và khoá ghi của s - 1, s, s + 1
+inline void ConcurrentInventoryManager::mergeAfterRemove(int s)
+{
+    int total = shardTotal.load();
+    Shard *shard = slotAt(s);
+    int size = shard->inventory.size();
+    if (size == 0)
+    {
+        removeSlot(s);
+        return;
+    }
+    int target = -1;
+    if (s > 0 && slotAt(s - 1)->inventory.size() + size <= shardCapacity)
+    {
+        target = s - 1;
+    }
+    else if (s + 1 < total && slotAt(s + 1)->inventory.size() + size <= shardCapacity)
+    {
+        target = s;
+    }
+    if (target < 0)
+    {
+        return;
+    }
+
+    // Chuyển toàn bộ phân đoạn target + 1 vào cuối phân đoạn target; start của target không đổi
+    const InventoryManager &source = slotAt(target + 1)->inventory;
+    List2D<InventoryAttribute> attributes;
+    List1D<std::string> names;
+    List1D<int> quantities;
+    for (int i = 0; i < source.size(); i++)
+    {
+        attributes.addRow(new List1D<InventoryAttribute>(source.getProductAttributes(i)));
+        names.add(source.getProductName(i));
+        quantities.add(source.getProductQuantity(i));
+    }
+    slotAt(target)->inventory.addProducts(attributes, names, quantities);
+    removeSlot(target + 1);
+}
+
+inline int ConcurrentInventoryManager::size() const
+{
+    return count.load();
+}
+
+inline int ConcurrentInventoryManager::shardCount() const
+{
+    return shardTotal.load();
+}
+
+inline List1D<InventoryAttribute> ConcurrentInventoryManager::getProductAttributes(int index) const
+{
+    int local;
+    std::shared_lock<std::shared_mutex> reading;
+    Shard *shard = lockProduct(index, local, reading);
+    return shard->inventory.getProductAttributes(local);
+}
+
+inline std::string ConcurrentInventoryManager::getProductName(int index) const
+{
+    int local;
+    std::shared_lock<std::shared_mutex> reading;
+    Shard *shard = lockProduct(index, local, reading);
+    return shard->inventory.getProductName(local);
+}
+
+inline int ConcurrentInventoryManager::getProductQuantity(int index) const
+{
+    int local;
+    std::shared_lock<std::shared_mutex> reading;
+    Shard *shard = lockProduct(index, local, reading);
+    return shard->inventory.getProductQuantity(local);
+}
+
+inline void ConcurrentInventoryManager::updateQuantity(int index, int newQuantity)
+{
+    int local;
+    std::unique_lock<std::shared_mutex> writing;
+    Shard *shard = lockProduct(index, local, writing);
+    shard->inventory.updateQuantity(local, newQuantity);
+}
+
+inline void ConcurrentInventoryManager::addProduct(const List1D<InventoryAttribute> &attributes,
+                                                   const std::string &name, int quantity)
+{
+    std::lock_guard<std::mutex> layout(structure);
+    int total = shardTotal.load();
+    if (total > 0)
+    {
+        Shard *last = slotAt(total - 1);
+        std::unique_lock<std::shared_mutex> writing(last->lock);
+        if (last->inventory.size() < shardCapacity)
+        {
+            last->inventory.addProduct(attributes, name, quantity);
+            count.store(count.load() + 1);
+            return;
+        }
+    }
+
+    // Phân đoạn cuối đã đầy: sản phẩm vào một phân đoạn mới, được công bố sau khi đã có dữ liệu
+    Shard *shard = spareShard();
+    std::unique_lock<std::shared_mutex> writing(shard->lock);
+    shard->inventory.addProduct(attributes, name, quantity);
+    shard->start.store(count.load());
+    freeShards.removeAt(freeShards.size() - 1);
+    appendSlot(shard);
+    count.store(count.load() + 1);
+}
+
+inline void ConcurrentInventoryManager::removeProduct(int index)
+{
+    std::lock_guard<std::mutex> layout(structure);
+    if (index < 0 || index >= count.load())
+    {
+        throw std::out_of_range("Index is invalid!");
+    }
+    const ShardDirectory *table = directory.load();
+    int total = shardTotal.load();
+    int s = findSlot(table, total, index);
+    Shard *shard = slotAt(s);
+    int local = index - shard->start.load();
+
+    // Khoá ghi từ phân đoạn kề trước (có thể được gộp) tới hết: mọi phân đoạn sau s lùi start một đơn vị.
+    // Khoá theo thứ tự id vì thứ tự trong bảng đổi khi phân đoạn được tái sử dụng
+    int first = s > 0 ? s - 1 : 0;
+    int lockCount = total - first;
+    std::unique_ptr<Shard *[]> ordered(new Shard *[lockCount]);
+    for (int t = first; t < total; t++)
+    {
+        Shard *next = slotAt(t);
+        int k = t - first;
+        for (; k > 0 && ordered[k - 1]->id > next->id; k--)
+        {
+            ordered[k] = ordered[k - 1];
+        }
+        ordered[k] = next;
+    }
+    std::unique_ptr<std::unique_lock<std::shared_mutex>[]> writing(new std::unique_lock<std::shared_mutex>[lockCount]);
+    for (int k = 0; k < lockCount; k++)
+    {
+        writing[k] = std::unique_lock<std::shared_mutex>(ordered[k]->lock);
+    }
+    shard->inventory.removeProduct(local);
+    for (int t = s + 1; t < total; t++)
+    {
+        Shard *next = slotAt(t);
+        next->start.store(next->start.load() - 1);
+    }
+    count.store(count.load() - 1);
+    mergeAfterRemove(s);
+}
+
+inline ConcurrentInventoryManager::ShardReadGuard::ShardReadGuard(const ConcurrentInventoryManager &owner)
+    : total(0), locked(false)
+{
+    while (true)
+    {
+        if (snapshot(owner))
+        {
+            lockAll();
+            if (covers(owner))
+            {
+                return;
+            }
+            release();
+        }
+        // Bảng vừa đổi giữa lúc chụp và lúc khoá: chụp lại
+        std::this_thread::yield();
+    }
+}
+
+// Chép các ô của bảng hiện tại; false nếu bảng đang đổi dở (ô trống hoặc một phân đoạn xuất hiện hai lần,
+// khi đó không được khoá đọc nó hai lần)
+inline bool ConcurrentInventoryManager::ShardReadGuard::snapshot(const ConcurrentInventoryManager &owner)
+{
+    int shardTotal = owner.shardTotal.load();
+    const ShardDirectory *table = owner.directory.load();
+    if (shardTotal > table->capacity)
+    {
+        return false;
+    }
+    view.reset(new Shard *[shardTotal > 0 ? shardTotal : 1]);
+    total = shardTotal;
+    for (int k = 0; k < total; k++)
+    {
+        view[k] = table->slots[k].load();
+        if (view[k] == nullptr)
+        {
+            return false;
+        }
+    }
+    int allocated = owner.allocatedShards.load();
+    std::unique_ptr<bool[]> seen(new bool[allocated > 0 ? allocated : 1]());
+    for (int k = 0; k < total; k++)
+    {
+        int id = view[k]->id;
+        if (id >= allocated || seen[id])
+        {
+            return false;
+        }
+        seen[id] = true;
+    }
+    return true;
+}
+
+// Khoá đọc mọi phân đoạn đã chụp mà không bao giờ chờ khi đang giữ khoá: chờ một khoá khi tay trắng,
+// thử các khoá còn lại, hụt thì trả hết rồi chờ đúng khoá vừa hụt
+inline void ConcurrentInventoryManager::ShardReadGuard::lockAll()
+{
+    int waitFor = 0;
+    while (total > 0)
+    {
+        view[waitFor]->lock.lock_shared();
+        int failed = -1;
+        for (int k = 0; k < total && failed < 0; k++)
+        {
+            if (k != waitFor && !view[k]->lock.try_lock_shared())
+            {
+                failed = k;
+            }
+        }
+        if (failed < 0)
+        {
+            break;
+        }
+        unlockAll(failed, waitFor);
+        waitFor = failed;
+    }
+    locked = true;
+}
+
+// Trả khoá của view[0, upTo) và của view[held]
+inline void ConcurrentInventoryManager::ShardReadGuard::unlockAll(int upTo, int held)
+{
+    for (int k = 0; k < upTo; k++)
+    {
+        if (k != held)
+        {
+            view[k]->lock.unlock_shared();
+        }
+    }
+    view[held]->lock.unlock_shared();
+}
+
+// Dưới khoá đọc: các phân đoạn đã chụp khác rỗng và nối tiếp nhau phủ đúng [0, size)
+inline bool ConcurrentInventoryManager::ShardReadGuard::covers(const ConcurrentInventoryManager &owner) const
+{
+    int expected = 0;
+    for (int k = 0; k < total; k++)
+    {
+        int size = view[k]->inventory.size();
+        if (size == 0 || view[k]->start.load() != expected)
+        {
+            return false;
+        }
+        expected += size;
+    }
+    return expected == owner.count.load();
+}
+
+inline void ConcurrentInventoryManager::ShardReadGuard::release()
+{
+    if (locked && total > 0)
+    {
+        unlockAll(total, total - 1);
+    }
+    locked = false;
+}
+
+inline List1D<std::string> ConcurrentInventoryManager::query(const std::string &attributeName,
+                                                             const double &minValue, const double &maxValue,
+                                                             int minQuantity, bool ascending) const
+{
+    ShardReadGuard reading(*this);
+    int parts = reading.size();
+    std::unique_ptr<List1D<std::string>[]> partial(new List1D<std::string>[parts > 0 ? parts : 1]);
+    for (int s = 0; s < parts; s++)
+    {
+        partial[s] = reading.get(s)->inventory.query(attributeName, minValue, maxValue, minQuantity, ascending);
+    }
+    reading.release();
+
+    // Kết quả từng phân đoạn đã tính xong trên cùng một trạng thái; trộn sau khi đã trả khoá
+    Heap<MergeCursor> pending(ascending ? &cursorAscending : &cursorDescending);
+    for (int s = 0; s < parts; s++)
+    {
+        if (partial[s].size() > 0)
+        {
+            pending.push(MergeCursor{partial[s].get(0), s, 0});
+        }
+    }
+    List1D<std::string> result;
+    while (!pending.empty())
+    {
+        MergeCursor cursor = pending.pop();
+        result.add(cursor.name);
+        if (cursor.position + 1 < partial[cursor.shard].size())
+        {
+            cursor.position++;
+            cursor.name = partial[cursor.shard].get(cursor.position);
+            pending.push(cursor);
+        }
+    }
+    return result;
+}
+
+inline InventoryManager ConcurrentInventoryManager::toInventory() const
+{
+    ShardReadGuard reading(*this);
+    List2D<InventoryAttribute> attributes;
+    List1D<std::string> names;
+    List1D<int> quantities;
+    for (int s = 0; s < reading.size(); s++)
+    {
+        const InventoryManager &inventory = reading.get(s)->inventory;
+        for (int i = 0; i < inventory.size(); i++)
+        {
+            attributes.addRow(new List1D<InventoryAttribute>(inventory.getProductAttributes(i)));
+            names.add(inventory.getProductName(i));
+            quantities.add(inventory.getProductQuantity(i));
+        }
+    }
+    reading.release();
+
+    InventoryManager inventory;
+    inventory.addProducts(attributes, names, quantities);
+    return inventory;
+}
+
+#endif // CONCURRENT_INVENTORY_H
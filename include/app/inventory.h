@@ -3,11 +3,32 @@
 
 #include "list/XArrayList.h"  // our concrete IList implementation
 #include "list/DLinkedList.h" // could also be used, but here we use XArrayList for simplicity
+#include "hash/xMap.h"
+#include "heap/Heap.h"
+#include "util/MurmurHash2_64.h"
 #include <sstream>
 #include <string>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <thread>
+#include <exception>
+#include <utility>
+#include <mutex>
+#include <shared_mutex>
+#include <memory>
+#include <atomic>
+#include <new>
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -25,12 +46,17 @@ public:
     List1D(int num_elements);
     List1D(const T *array, int num_elements);
     List1D(const List1D<T> &other);
+    List1D(List1D<T> &&other); // lấy luôn danh sách bên trong, other trở thành danh sách rỗng
+    List1D<T> &operator=(const List1D<T> &other);
     virtual ~List1D();
 
     int size() const;
     T get(int index) const;
     void set(int index, T value);
     void add(const T &value);
+    void reserve(int capacity); // cấp phát trước, không đổi size
+    // Xoá trong một lượt mọi phần tử có removed[i] == true, giữ nguyên thứ tự phần còn lại
+    void compact(XArrayList<bool> &removed);
     string toString() const;
 
     // NEW: Remove element at index.
@@ -60,9 +86,11 @@ public:
     List2D();
     List2D(List1D<T> *array, int num_rows);
     List2D(const List2D<T> &other);
+    List2D<T> &operator=(const List2D<T> &other);
     virtual ~List2D();
 
     int rows() const;
+    void reserve(int numRows);
     void setRow(int rowIndex, const List1D<T> &row);
     T get(int rowIndex, int colIndex) const;
     List1D<T> getRow(int rowIndex) const;
@@ -72,6 +100,8 @@ public:
     void addRow(List1D<T> *row);
     // NEW: Remove a row at rowIndex.
     void removeRow(int rowIndex);
+    // Xoá (và giải phóng) trong một lượt mọi hàng có removed[i] == true, giữ nguyên thứ tự
+    void compact(XArrayList<bool> &removed);
 
     /*
      * Overload toán tử << để hỗ trợ in danh sách
@@ -85,14 +115,196 @@ public:
         return os;
     }
 };
+// -------------------- CowColumn --------------------
+// Danh sách chia thành các khối CHUNK_SIZE phần tử giữ bằng shared_ptr, dùng làm cột dữ liệu của
+// InventoryManager. Sao chép một CowColumn là O(1): hai bản dùng chung mảng con trỏ khối; lần ghi đầu tiên
+// sau đó sao chép mảng con trỏ khối (O(n / CHUNK_SIZE)) rồi chỉ sao chép những khối bị ghi. Khối đang
+// được dùng chung không bao giờ bị ghi, nên một bản sao đọc được ở luồng khác trong khi bản gốc vẫn bị sửa
+template <typename T>
+class CowColumn
+{
+public:
+    static constexpr int CHUNK_SIZE = 512;
+
+    CowColumn();
+    explicit CowColumn(const List1D<T> &list);
+
+    int size() const { return count; }
+    const T &get(int index) const;
+    void set(int index, const T &value);
+    void add(const T &value);
+    void add(T &&value);
+    void removeAt(int index);
+    void reserve(int capacity);
+    // Bỏ các phần tử từ newCount trở đi
+    void truncate(int newCount);
+    // Con trỏ tới phần tử index; các phần tử sau nó liền kề nhau tới hết khối chứa nó
+    const T *block(int index) const;
+    // Xoá trong một lượt mọi phần tử có removed[i] == true, giữ nguyên thứ tự phần còn lại. Các khối
+    // đứng trước phần tử bị xoá đầu tiên không bị chạm tới (vẫn dùng chung nếu đang dùng chung)
+    void compact(XArrayList<bool> &removed);
+    List1D<T> toList() const;
+
+private:
+    struct Chunk
+    {
+        int count;
+        T *items; // vùng nhớ thô CHUNK_SIZE phần tử, chỉ count phần tử đầu đã được khởi tạo
+
+        Chunk() : count(0), items(static_cast<T *>(::operator new(sizeof(T) * CHUNK_SIZE))) {}
+        Chunk(const Chunk &other) : Chunk()
+        {
+            for (; count < other.count; count++)
+                new (items + count) T(other.items[count]);
+        }
+        ~Chunk()
+        {
+            for (int i = 0; i < count; i++)
+                items[i].~T();
+            ::operator delete(items);
+        }
+        Chunk &operator=(const Chunk &) = delete;
+    };
+    struct Spine
+    {
+        XArrayList<shared_ptr<Chunk>> chunks; // mọi khối đầy trừ khối cuối
+    };
+
+    shared_ptr<Spine> spine;
+    int count;
+
+    Spine &writableSpine();
+    Chunk &writableChunk(int chunkIndex);
+    Chunk &appendSlot();
+
+    // use_count đọc không đồng bộ: rào acquire để mọi lần đọc của bản sao vừa được huỷ ở luồng khác
+    // xảy ra trước lần ghi tiếp theo
+    template <typename P>
+    static bool exclusive(const shared_ptr<P> &pointer)
+    {
+        if (pointer.use_count() != 1)
+            return false;
+        atomic_thread_fence(memory_order_acquire);
+        return true;
+    }
+};
+
+// -------------------- CowRows --------------------
+// Các hàng thuộc tính của InventoryManager trên một CowColumn, giao diện theo List2D. Hàng đã thêm không
+// bao giờ bị sửa nên được giữ bằng shared_ptr tới List1D bất biến: sao chép một khối chỉ tăng số tham
+// chiếu của các hàng chứ không sao chép thuộc tính
+template <typename T>
+class CowRows
+{
+public:
+    CowRows() {}
+    explicit CowRows(const List2D<T> &matrix);
+
+    int rows() const { return items.size(); }
+    List1D<T> getRow(int rowIndex) const { return *items.get(rowIndex); }
+    // Tham chiếu tới dòng bất biến, không sao chép; hợp lệ tới lần ghi kế tiếp vào chính đối tượng này
+    const List1D<T> &row(int rowIndex) const { return *items.get(rowIndex); }
+    void addRow(List1D<T> *row) { items.add(shared_ptr<const List1D<T>>(row)); } // nhận quyền sở hữu row
+    void removeRow(int rowIndex) { items.removeAt(rowIndex); }
+    void reserve(int numRows) { items.reserve(numRows); }
+    void compact(XArrayList<bool> &removed) { items.compact(removed); }
+    List2D<T> toList2D() const;
+
+private:
+    CowColumn<shared_ptr<const List1D<T>>> items;
+};
+
+// -------------------- AttributeNamePool --------------------
+// Bảng intern tên thuộc tính dùng chung toàn chương trình: mỗi tên phân biệt được cấp một mã 32 bit ổn
+// định và đúng một bản lưu (địa chỉ không đổi tới khi chương trình kết thúc), nên hai tên bằng nhau khi
+// và chỉ khi mã bằng nhau. Tra theo dấu vân tay MurmurHash64A như ContentTable của InventoryManager.
+// An toàn luồng: tra cứu dùng khoá đọc, chỉ việc thêm tên mới dùng khoá ghi
+class AttributeNamePool
+{
+public:
+    static constexpr uint32_t EMPTY_ID = 0; // chuỗi rỗng có sẵn mã 0
+
+    static AttributeNamePool &instance();
+    // Mã của name, cấp mã mới nếu chưa có; stored (nếu khác nullptr) nhận địa chỉ bản lưu
+    uint32_t intern(const string &name, const string **stored = nullptr);
+    // Tra mã mà không thêm tên mới; false nếu name chưa từng được intern
+    bool find(const string &name, uint32_t &id) const;
+    const string *text(uint32_t id) const;
+    const string *emptyText() const { return empty; }
+    int size() const;
+
+private:
+    mutable xMap<uint64_t, uint32_t> byFingerprint;
+    mutable xMap<string, uint32_t> *collisions; // tên trùng dấu vân tay với một tên khác
+    mutable XArrayList<string *> texts;         // mã -> bản lưu duy nhất
+    const string *empty;
+    mutable shared_mutex lock;
+
+    AttributeNamePool();
+    ~AttributeNamePool();
+    bool lookup(const string &name, uint64_t fingerprint, uint32_t &id) const;
+    static int fingerprintHash(uint64_t &key, int capacity) { return (int)(key % (uint64_t)capacity); }
+    static int textHash(string &key, int capacity);
+    AttributeNamePool(const AttributeNamePool &) = delete;
+    AttributeNamePool &operator=(const AttributeNamePool &) = delete;
+};
+
+// -------------------- AttributeName --------------------
+// Tên thuộc tính đã intern: mã 32 bit và con trỏ tới bản lưu trong AttributeNamePool. So sánh hai
+// AttributeName là so sánh số nguyên; đọc nội dung như một const string& (chuyển đổi ngầm hoặc str()).
+// Gán/khởi tạo ngầm từ string hoặc chuỗi C và các hàm length(), c_str(), empty()... giữ cho mã cũ viết
+// với `string name` (attr.name = "h", attr.name.length()) vẫn biên dịch được
+class AttributeName
+{
+public:
+    AttributeName() : nameId(AttributeNamePool::EMPTY_ID), text(AttributeNamePool::instance().emptyText()) {}
+    AttributeName(const string &name);
+    AttributeName(const char *name) : AttributeName(string(name)) {}
+
+    uint32_t id() const { return nameId; }
+    const string &str() const { return *text; }
+    operator const string &() const { return *text; }
+
+    size_t length() const { return text->length(); }
+    size_t size() const { return text->size(); }
+    bool empty() const { return text->empty(); }
+    const char *c_str() const { return text->c_str(); }
+    char operator[](size_t pos) const { return (*text)[pos]; }
+    string substr(size_t pos = 0, size_t count = string::npos) const { return text->substr(pos, count); }
+    size_t find(const string &part, size_t pos = 0) const { return text->find(part, pos); }
+
+    bool operator==(const AttributeName &other) const { return nameId == other.nameId; }
+    bool operator!=(const AttributeName &other) const { return nameId != other.nameId; }
+    friend bool operator==(const AttributeName &lhs, const string &rhs) { return *lhs.text == rhs; }
+    friend bool operator==(const string &lhs, const AttributeName &rhs) { return lhs == *rhs.text; }
+    friend bool operator!=(const AttributeName &lhs, const string &rhs) { return *lhs.text != rhs; }
+    friend bool operator!=(const string &lhs, const AttributeName &rhs) { return lhs != *rhs.text; }
+    friend bool operator==(const AttributeName &lhs, const char *rhs) { return *lhs.text == rhs; }
+    friend bool operator==(const char *lhs, const AttributeName &rhs) { return lhs == *rhs.text; }
+    friend bool operator!=(const AttributeName &lhs, const char *rhs) { return *lhs.text != rhs; }
+    friend bool operator!=(const char *lhs, const AttributeName &rhs) { return lhs != *rhs.text; }
+    friend string operator+(const AttributeName &lhs, const AttributeName &rhs) { return *lhs.text + *rhs.text; }
+    friend string operator+(const AttributeName &lhs, const string &rhs) { return *lhs.text + rhs; }
+    friend string operator+(const string &lhs, const AttributeName &rhs) { return lhs + *rhs.text; }
+    friend string operator+(const AttributeName &lhs, const char *rhs) { return *lhs.text + rhs; }
+    friend string operator+(const char *lhs, const AttributeName &rhs) { return lhs + *rhs.text; }
+    friend ostream &operator<<(ostream &os, const AttributeName &name) { return os << *name.text; }
+
+private:
+    uint32_t nameId;
+    const string *text;
+};
+
 // -------------------- InventoryAttribute --------------------
 struct InventoryAttribute
 {
-    string name;
+    AttributeName name; // tên đã intern, dùng chung bản lưu giữa các sản phẩm
     double value;
-    InventoryAttribute() : name(""), value(0.0) {} // Constructor mặc định
+    InventoryAttribute() : value(0.0) {} // Constructor mặc định
     InventoryAttribute(const string &name, double value) : name(name), value(value) {}
-    string toString() const { return name + ": " + to_string(value); }
+    InventoryAttribute(const char *name, double value) : name(name), value(value) {}
+    InventoryAttribute(const AttributeName &name, double value) : name(name), value(value) {}
+    string toString() const { return name.str() + ": " + to_string(value); }
 
     /////////////// Toán tử == cho InventoryAttribute//////////////////////
     bool operator==(const InventoryAttribute &other) const
@@ -108,13 +320,286 @@ inline ostream &operator<<(ostream &os, const InventoryAttribute &attr)
     return os;
 }
 
+// Một vế của truy vấn nhiều điều kiện (InventoryManager::query với List1D<AttributeRange>): sản phẩm có
+// ít nhất một thuộc tính tên name với giá trị trong [minValue, maxValue]
+struct AttributeRange
+{
+    string name;
+    double minValue;
+    double maxValue;
+    AttributeRange() : minValue(0.0), maxValue(0.0) {}
+    AttributeRange(const string &name, double minValue, double maxValue)
+        : name(name), minValue(minValue), maxValue(maxValue) {}
+
+    bool operator==(const AttributeRange &other) const
+    {
+        return name == other.name && minValue == other.minValue && maxValue == other.maxValue;
+    }
+};
+
+inline ostream &operator<<(ostream &os, const AttributeRange &range)
+{
+    os << range.name << " in [" << range.minValue << ", " << range.maxValue << "]";
+    return os;
+}
+
+// -------------------- Inventory record lines --------------------
+// Một sản phẩm trên một dòng văn bản: "tên<d>số lượng<d>thuộc tính=giá trị<d>..." (d là ',' hoặc '\t').
+// Dòng rỗng hoặc sai định dạng bị từ chối (trả về false), không ném ngoại lệ
+bool parseInventoryRecord(const string &line, char delimiter, string &name, int &quantity,
+                          List1D<InventoryAttribute> &attributes);
+// Phiên bản trên vùng [first, last) không chứa ký tự xuống dòng; thuộc tính được nối vào attributes
+// (nơi gọi truyền danh sách rỗng, có thể đã reserve). Dùng cho nạp hàng loạt không sao chép dòng
+bool parseInventoryRecord(const char *first, const char *last, char delimiter, string &name, int &quantity,
+                          List1D<InventoryAttribute> &attributes);
+string formatInventoryRecord(const string &name, int quantity, const List1D<InventoryAttribute> &attributes,
+                             char delimiter);
+// Dạng thập phân ngắn nhất (15..17 chữ số có nghĩa) mà strtod đọc lại đúng giá trị ban đầu
+string formatExactValue(double value);
+
+// -------------------- IRecordCodec --------------------
+// Bộ mã hoá một sản phẩm (tên + thuộc tính) thành chuỗi byte, dùng cho chế độ lưu nén của
+// InventoryManager. InventoryCompressor hiện thực giao diện này bằng mô hình Huffman của nó
+class IRecordCodec
+{
+public:
+    virtual ~IRecordCodec() {}
+    virtual string encodeRecord(const List1D<InventoryAttribute> &attributes, const string &name) = 0;
+    // Trả về false nếu bản ghi hỏng
+    virtual bool decodeRecord(const string &record, List1D<InventoryAttribute> &attributes, string &name) = 0;
+
+    // Truy vấn không giải nén: encodeAttributeKey được gọi một lần cho mỗi truy vấn; matchAttribute trả về
+    // 1/0 nếu bản ghi có/không có thuộc tính trùng tên với giá trị trong [minValue, maxValue], -1 nếu
+    // codec không trả lời được cho bản ghi này (khi đó kho giải mã đầy đủ)
+    virtual string encodeAttributeKey(const string &attributeName) = 0;
+    virtual int matchAttribute(const string &record, const string &key, double minValue, double maxValue) = 0;
+};
+
+// -------------------- ColumnarStore --------------------
+// Lưu thuộc tính của các sản phẩm theo cột (structure of arrays) cho chế độ lưu theo cột của
+// InventoryManager. Cột được tra theo mã intern của tên thuộc tính (AttributeNamePool); mỗi cột là một mảng double liên tục
+// kèm bitmap có mặt (hàng không có thuộc tính chỉ tốn 1 bit), số lượng nằm trong một mảng int liên tục.
+// Lần xuất hiện thứ k của một tên trong cùng sản phẩm nằm ở cột thứ k của tên đó, và mỗi hàng giữ danh
+// sách cột theo đúng thứ tự thuộc tính để dựng lại List1D ban đầu.
+// Mọi cột là CowColumn: sao chép kho chỉ chia sẻ các khối (O(số cột + số hàng / CHUNK_SIZE)), lần ghi sau
+// đó chỉ sao chép những khối bị sửa. filter quét cột bằng AVX2 khi biên dịch với -mavx2, ngược lại bằng
+// vòng lặp vô hướng
+class ColumnarStore
+{
+public:
+    ColumnarStore();
+    ColumnarStore(const ColumnarStore &other);
+    ColumnarStore &operator=(const ColumnarStore &other);
+    ~ColumnarStore();
+
+    int size() const { return rows; }
+    int columnCount() const { return columnTotal; }
+    void reserve(int rowCapacity);
+    void addRow(const List1D<InventoryAttribute> &attributes, int quantity);
+    List1D<InventoryAttribute> getRow(int row) const;
+    int getQuantity(int row) const { return quantityColumn.get(row); }
+    void setQuantity(int row, int quantity) { quantityColumn.set(row, quantity); }
+    void removeRow(int row);
+    // Xoá trong một lượt các hàng có removed[i] == true; hàng giữ lại nhận số lượng quantities[i]
+    void compact(XArrayList<bool> &removed, XArrayList<int> &quantities);
+    // Thêm vào matches (tăng dần) các hàng có thuộc tính name với giá trị trong [minValue, maxValue]
+    // và số lượng >= minQuantity
+    void filter(const string &name, double minValue, double maxValue, int minQuantity,
+                XArrayList<int> &matches) const;
+    // Hàng row có thuộc tính mã nameId với giá trị trong [minValue, maxValue] không
+    bool rowInRange(int row, uint32_t nameId, double minValue, double maxValue) const;
+    // Ước lượng số hàng thoả rowInRange: số hàng có tên (đếm bit có mặt của cột đầu tiên) nhân tỉ lệ
+    // thoả trên một mẫu cách đều tối đa SAMPLE_ROWS hàng. Trả về 0 khi và chỉ khi không hàng nào có tên
+    static constexpr int SAMPLE_ROWS = 256;
+    int estimateRows(uint32_t nameId, double minValue, double maxValue) const;
+
+private:
+    struct Column
+    {
+        AttributeName name;
+        int next; // cột của lần xuất hiện kế tiếp cùng tên trong một hàng, -1 nếu chưa có
+        CowColumn<double> values;
+        CowColumn<uint64_t> present;
+    };
+
+    int rows;
+    // Số hàng đã có chỗ trong mọi cột (đệm 0), bội số của 64 để bitmap và vòng SIMD không có phần dư;
+    // CHUNK_SIZE cũng là bội số của 64 nên 64 hàng của một từ bitmap luôn nằm liền trong một khối
+    int capacity;
+    CowColumn<int> quantityColumn;
+    Column *columns;
+    int columnTotal;
+    int columnCapacity;
+    // Các cột của hàng r theo thứ tự thuộc tính: cellColumns[cellStart[r] .. cellStart[r + 1])
+    CowColumn<int> cellStart;
+    CowColumn<int> cellColumns;
+
+    // Mã tên -> cột của lần xuất hiện đầu tiên, -1 nếu chưa có (XArrayList không có get const)
+    mutable XArrayList<int> firstColumn;
+
+    int columnFor(const AttributeName &name, int occurrence);
+    void ensureRows(int count);
+    void copyFrom(const ColumnarStore &other);
+    void release();
+    uint64_t rangeMask(const Column &column, int word, double minValue, double maxValue) const;
+    uint64_t quantityMask(int word, int minQuantity) const;
+
+    template <typename T>
+    static T *grow(T *array, int count, int newCapacity);
+    template <typename T>
+    static void pad(CowColumn<T> &column, int count)
+    {
+        column.reserve(count);
+        while (column.size() < count)
+            column.add(T());
+    }
+    // Chỉ ghi khi giá trị đổi, để khối không bị sửa vẫn được dùng chung. So sánh theo byte để 0.0 và -0.0
+    // (bằng nhau theo ==) vẫn được ghi đè
+    template <typename T>
+    static void update(CowColumn<T> &column, int index, const T &value)
+    {
+        if (memcmp(&column.get(index), &value, sizeof(T)) != 0)
+            column.set(index, value);
+    }
+    static void assignBit(CowColumn<uint64_t> &bits, int index, bool value)
+    {
+        uint64_t word = bits.get(index >> 6);
+        if (value)
+            word |= 1ULL << (index & 63);
+        else
+            word &= ~(1ULL << (index & 63));
+        update(bits, index >> 6, word);
+    }
+    static bool testBit(const CowColumn<uint64_t> &bits, int index)
+    {
+        return (bits.get(index >> 6) >> (index & 63)) & 1ULL;
+    }
+};
+
 // -------------------- InventoryManager --------------------
 class InventoryManager
 {
 private:
-    List2D<InventoryAttribute> attributesMatrix;
-    List1D<string> productNames;
-    List1D<int> quantities;
+    // Các cột sản phẩm là CowColumn/CowRows: sao chép kho (snapshot, hàm dựng sao chép) chỉ chia sẻ các khối
+    CowRows<InventoryAttribute> attributesMatrix;
+    CowColumn<string> productNames;
+    CowColumn<int> quantities;
+
+    // Chế độ lưu nén: mỗi sản phẩm chỉ giữ bản ghi đã mã hoá trong encodedRecords (attributesMatrix và
+    // productNames rỗng), giải mã khi truy cập qua một bộ đệm ánh xạ trực tiếp (ô = chỉ số % sức chứa)
+    struct CachedProduct
+    {
+        int index; // -1 = ô trống
+        string name;
+        List1D<InventoryAttribute> attributes;
+        CachedProduct() : index(-1) {}
+
+        // XArrayList yêu cầu so sánh và in phần tử
+        bool operator==(const CachedProduct &other) const { return index == other.index; }
+        friend ostream &operator<<(ostream &os, const CachedProduct &product) { return os << product.index; }
+    };
+    IRecordCodec *codec; // nullptr = lưu dạng thường
+    CowColumn<string> encodedRecords;
+    mutable XArrayList<CachedProduct> decodeCache;
+
+    const CachedProduct &decodeProduct(int index) const;
+    void resetDecodeCache(int capacity) const;
+
+    // Chế độ lưu theo cột: thuộc tính và (bản sao) số lượng nằm trong columns, attributesMatrix rỗng.
+    // Các bản sao của kho dùng chung columns; lần ghi đầu tiên sau khi sao chép tách ra một bản riêng
+    shared_ptr<ColumnarStore> columns; // nullptr = lưu theo hàng
+    ColumnarStore &writableColumns();
+
+    // Chỉ mục phụ theo tên thuộc tính: mỗi tên -> các cặp (giá trị, chỉ số sản phẩm) tăng dần theo
+    // (giá trị, chỉ số). Chỉ mục của một tên được dựng lười ở truy vấn đầu tiên theo tên đó; sau đó
+    // addProduct chèn, removeProduct xoá và dịch chỉ số. Số lượng không nằm trong chỉ mục (query đọc
+    // trực tiếp quantities) nên updateQuantity không phải cập nhật gì
+    struct IndexEntry
+    {
+        double value;
+        int product;
+
+        bool operator==(const IndexEntry &other) const { return value == other.value && product == other.product; }
+        bool operator<(const IndexEntry &other) const { return value < other.value || (value == other.value && product < other.product); }
+        bool operator>(const IndexEntry &other) const { return other < *this; }
+        friend ostream &operator<<(ostream &os, const IndexEntry &entry) { return os << "(" << entry.value << ", " << entry.product << ")"; }
+    };
+    typedef XArrayList<IndexEntry> AttributeIndex;
+    bool attributeIndexing;
+    mutable xMap<uint32_t, AttributeIndex *> *attributeIndexes; // mã tên -> chỉ mục, nullptr khi chưa dựng
+    static int nameIdHash(uint32_t &key, int capacity) { return (int)(key % (uint32_t)capacity); }
+
+    // Chỉ mục tên sản phẩm -> các chỉ số (tăng dần), dựng lười và được cập nhật khi thêm/xoá
+    mutable xMap<string, XArrayList<int> *> *nameIndex; // nullptr khi chưa dựng
+
+    // Bảng khoá nội dung (xem productKey) -> chỉ số. xMap chỉ băm dấu vân tay 64 bit (MurmurHash64A)
+    // của khoá nên mỗi thao tác không phải sao chép chuỗi; khoá đầy đủ được giữ để xác nhận, khoá
+    // trùng dấu vân tay với một khoá khác rơi vào bảng phụ theo chuỗi
+    class ContentTable
+    {
+    public:
+        ContentTable() : byFingerprint(&fingerprintHash), collisions(nullptr) {}
+        ~ContentTable() { delete collisions; }
+        // Trả về chỉ số đã gắn với key, hoặc gắn key với index rồi trả về -1
+        int findOrInsert(const string &key, int index);
+
+    private:
+        xMap<uint64_t, int> byFingerprint; // dấu vân tay -> vị trí trong keys/indices
+        XArrayList<string> keys;
+        XArrayList<int> indices;
+        xMap<string, int> *collisions;
+
+        static int fingerprintHash(uint64_t &key, int capacity) { return (int)(key % (uint64_t)capacity); }
+        ContentTable(const ContentTable &) = delete;
+        ContentTable &operator=(const ContentTable &) = delete;
+    };
+
+    // Chế độ gộp khi thêm: bảng khoá nội dung của các sản phẩm hiện có, dựng lười và bị huỷ khi chỉ số
+    // dịch chuyển (xoá, nạp hàng loạt)
+    bool dedupeOnInsert;
+    mutable ContentTable *productKeys;
+
+    static int nameHash(string &key, int capacity);
+    // Tên các sản phẩm khớp điều kiện của query, theo thứ tự chỉ số sản phẩm
+    void collectMatches(const string &attributeName, const double &minValue, const double &maxValue,
+                        int minQuantity, XArrayList<string> &matches) const;
+    // So sánh tên cho Heap<string>: đỉnh heap là tên đứng đầu theo thứ tự tăng/giảm
+    static int nameAscending(string &lhs, string &rhs) { return lhs.compare(rhs); }
+    static int nameDescending(string &lhs, string &rhs) { return rhs.compare(lhs); }
+    static string productKey(const string &name, const List1D<InventoryAttribute> &attributes);
+    void clearProductKeys() const;
+    XArrayList<int> *productsNamed(const string &name, bool create) const;
+    void clearNameIndex() const;
+    static void removeFromIndexList(XArrayList<int> &indices, int index);
+    // Xoá một lượt các sản phẩm được đánh dấu, số lượng mới lấy từ newQuantities (cùng chỉ số cũ)
+    void compactProducts(XArrayList<bool> &removed, XArrayList<int> &newQuantities);
+    // nullptr nếu attributeName chưa từng được intern (không sản phẩm nào có), khi đó không dựng gì
+    AttributeIndex *attributeIndex(const string &attributeName) const;
+    // Vị trí đầu tiên trong index có giá trị >= value (after = false) hoặc > value (after = true)
+    static int indexBound(AttributeIndex &index, double value, bool after);
+
+    // Kế hoạch cho một vế của truy vấn nhiều điều kiện: estimate là số hàng ước lượng thoả vế (chính xác
+    // khi có chỉ mục phụ: số mục trong [first, last) của index)
+    struct RangePlan
+    {
+        const AttributeRange *range;
+        uint32_t nameId;
+        int estimate;
+        AttributeIndex *index; // nullptr khi không bật chỉ mục phụ
+        int first;
+        int last;
+        string key; // tên thuộc tính đã mã hoá (chế độ lưu nén)
+    };
+    // Một lần kiểm tra trực tiếp một ứng viên tốn cỡ ROW_CHECK_COST lần đánh dấu một mục chỉ mục
+    static constexpr int ROW_CHECK_COST = 4;
+    bool rowInRange(int row, const RangePlan &plan) const;
+    static bool attributesInRange(const List1D<InventoryAttribute> &attributes, const RangePlan &plan);
+    // Các chỉ số (không trùng, không theo thứ tự) của sản phẩm thoả mọi vế và có số lượng >= minQuantity
+    void collectMatches(const List1D<AttributeRange> &ranges, int minQuantity, XArrayList<int> &rows) const;
+    static List1D<string> orderNames(XArrayList<string> &names, bool ascending);
+    void indexProduct(int index, const List1D<InventoryAttribute> &attributes);
+    void unindexProduct(int index);
+    void clearAttributeIndexes() const;
 
 public:
     InventoryManager();
@@ -122,6 +607,14 @@ public:
                      const List1D<string> &names,
                      const List1D<int> &quantities);
     InventoryManager(const InventoryManager &other);
+    InventoryManager &operator=(const InventoryManager &other);
+    ~InventoryManager();
+
+    // Ảnh chụp nhất quán của kho trong O(1): các cột được chia sẻ theo khối, kho gốc chỉ sao chép những
+    // khối nó ghi sau đó nên ảnh chụp không bao giờ đổi. Gọi ở luồng ghi (hoặc khi đang giữ khoá của luồng
+    // ghi) rồi giao ảnh chụp cho một luồng đọc; luồng đọc dùng nó không cần khoá trong khi luồng ghi tiếp
+    // tục sửa kho. Mỗi luồng đọc cần ảnh chụp riêng vì chỉ mục dựng lười và bộ đệm giải mã là của từng bản
+    InventoryManager snapshot() const { return *this; }
 
     int size() const;
     List1D<InventoryAttribute> getProductAttributes(int index) const;
@@ -131,13 +624,37 @@ public:
     void addProduct(const List1D<InventoryAttribute> &attributes, const string &name, int quantity);
     void removeProduct(int index);
 
+    // Các thao tác theo lô: kiểm tra toàn bộ lô trước (ném ngoại lệ thì kho không đổi), áp dụng trong một
+    // lượt trên mỗi cột và huỷ các chỉ mục phụ/bảng khoá một lần cho cả lô.
+    // addProducts nối các hàng theo thứ tự (ở chế độ gộp khi thêm, bản trùng được gộp sau khi nối);
+    // removeProducts xoá mọi chỉ số trong indices (thứ tự tuỳ ý, chỉ số lặp được bỏ qua) bằng một lượt
+    // dồn mảng; updateQuantities đặt quantities[k] cho sản phẩm indices[k]
+    void addProducts(const List2D<InventoryAttribute> &attributes, const List1D<string> &names,
+                     const List1D<int> &quantities);
+    void removeProducts(const List1D<int> &indices);
+    void updateQuantities(const List1D<int> &indices, const List1D<int> &newQuantities);
+
     // Query by attribute index (zero-based) within [minValue, maxValue] and with quantity at least minQuantity.
     // Result is sorted lexicographically if ascending is true.
     List1D<string> query(string attributeName, const double &minValue,
                          const double &maxValue, int minQuantity, bool ascending) const;
+    // Một trang của kết quả query: bỏ offset tên đầu rồi lấy tối đa limit tên theo cùng thứ tự. Chỉ giữ
+    // offset + limit tên tốt nhất trong một Heap<string> bị chặn nên không sắp xếp toàn bộ kết quả,
+    // O(n log(offset + limit)). Ném invalid_argument nếu offset hoặc limit âm
+    List1D<string> queryPage(string attributeName, const double &minValue, const double &maxValue,
+                             int minQuantity, bool ascending, int offset, int limit) const;
+    // Truy vấn hội nhiều vế: sản phẩm thoả mọi khoảng trong ranges (mỗi vế có thể khớp một thuộc tính
+    // khác nhau) và có số lượng >= minQuantity; ranges rỗng chỉ lọc theo số lượng. Bộ lập kế hoạch ước
+    // lượng số hàng của từng vế (chính xác trên chỉ mục phụ, lấy mẫu trên các cột, toàn kho nếu quét
+    // hàng), lấy tập ứng viên từ vế chọn lọc nhất rồi giao với các vế còn lại bằng bitmap trên chỉ mục hoặc
+    // kiểm tra trực tiếp từng ứng viên, tuỳ cách nào rẻ hơn; tên chỉ được lấy cho các sản phẩm cuối cùng
+    List1D<string> query(const List1D<AttributeRange> &ranges, int minQuantity, bool ascending) const;
 
     void removeDuplicates();
 
+    // Gộp hai kho: kết quả như nối inv2 vào sau inv1 rồi removeDuplicates (giữ thứ tự xuất hiện đầu
+    // tiên, cộng số lượng bản trùng) nhưng chạy một lượt O(n + m) bằng phép nối băm theo khoá nội dung.
+    // Kết quả kế thừa các chế độ của inv1 (lưu nén, chỉ mục phụ, gộp khi thêm)
     static InventoryManager merge(const InventoryManager &inv1,
                                   const InventoryManager &inv2);
 
@@ -149,7 +666,159 @@ public:
     List1D<string> getProductNames() const;
     List1D<int> getQuantities() const;
     string toString() const;
+
+    // Nạp hàng loạt tệp CSV/TSV (mỗi dòng một bản ghi, xem parseInventoryRecord). Tệp được chia thành
+    // threadCount đoạn tại ranh giới dòng và phân tích song song (0 = số lõi), các hàng thuộc tính
+    // được reserve đúng số cột rồi nối vào kho một lần theo đúng thứ tự trong tệp.
+    // Trả về số dòng hợp lệ đã nạp (dòng rỗng/sai định dạng bị bỏ qua; ở chế độ gộp khi thêm, các dòng
+    // trùng được gộp sau khi nối), -1 nếu không mở được tệp
+    int loadFromFile(const string &path, char delimiter = ',', int threadCount = 0);
+
+    // Bật/tắt chế độ lưu nén. Khi bật, mọi sản phẩm (hiện có và thêm sau) được mã hoá bằng codec;
+    // getProductName/getProductAttributes giải mã theo yêu cầu và giữ tối đa cacheCapacity sản phẩm
+    // vừa giải mã. Codec phải sống lâu hơn kho và không được đổi mô hình khi chế độ đang bật.
+    static constexpr int DEFAULT_CACHE_CAPACITY = 64;
+    void enableCompressedStorage(IRecordCodec *codec, int cacheCapacity = DEFAULT_CACHE_CAPACITY);
+    void disableCompressedStorage();
+    bool isCompressedStorage() const { return codec != nullptr; }
+    long compressedBytes() const; // tổng kích thước các bản ghi đã mã hoá
+
+    // Bật/tắt chế độ lưu theo cột (xem ColumnarStore): query không dùng chỉ mục phụ quét các cột giá trị
+    // liên tục thay vì từng hàng thuộc tính. Loại trừ với chế độ lưu nén (bật chế độ này tắt chế độ kia)
+    void enableColumnarStorage();
+    void disableColumnarStorage();
+    bool isColumnarStorage() const { return columns != nullptr; }
+
+    // Bật/tắt chỉ mục phụ cho query: khi bật, truy vấn theo một tên thuộc tính tìm nhị phân cận dưới
+    // minValue trên chỉ mục sắp xếp của tên đó rồi chỉ duyệt các giá trị trong khoảng, O(log n + k)
+    void setAttributeIndexing(bool enabled);
+    bool isAttributeIndexing() const { return attributeIndexing; }
+
+    // Các chỉ số (tăng dần) của sản phẩm có tên name, tra bằng chỉ mục băm theo tên
+    List1D<int> findByName(const string &name) const;
+
+    // Khi bật, addProduct cộng số lượng vào sản phẩm trùng (cùng tên và thuộc tính) thay vì thêm mới;
+    // bật chế độ sẽ gộp luôn các bản trùng hiện có
+    void setDedupeOnInsert(bool enabled);
+    bool isDedupeOnInsert() const { return dedupeOnInsert; }
 };
+//////////////// -- -- -- -- -- --AttributeNamePool Method Definitions-- -- -- -- -- --////////////////////////////////
+inline AttributeNamePool &AttributeNamePool::instance()
+{
+    static AttributeNamePool pool;
+    return pool;
+}
+
+inline AttributeNamePool::AttributeNamePool() : byFingerprint(&fingerprintHash), collisions(nullptr)
+{
+    string *blank = new string();
+    byFingerprint.put(MurmurHash64A(blank->data(), 0, 0), EMPTY_ID);
+    texts.add(blank);
+    empty = blank;
+}
+
+inline AttributeNamePool::~AttributeNamePool()
+{
+    for (int i = 0; i < texts.size(); i++)
+    {
+        delete texts.get(i);
+    }
+    delete collisions;
+}
+
+inline int AttributeNamePool::textHash(string &key, int capacity)
+{
+    return (int)(MurmurHash64A(key.data(), (int)key.length(), 0) % (uint64_t)capacity);
+}
+
+// Gọi khi đang giữ khoá (đọc hoặc ghi)
+inline bool AttributeNamePool::lookup(const string &name, uint64_t fingerprint, uint32_t &id) const
+{
+    if (!byFingerprint.containsKey(fingerprint))
+    {
+        return false;
+    }
+    id = byFingerprint.get(fingerprint);
+    if (*texts.get(id) == name)
+    {
+        return true;
+    }
+    if (collisions != nullptr && collisions->containsKey(name))
+    {
+        id = collisions->get(name);
+        return true;
+    }
+    return false;
+}
+
+inline uint32_t AttributeNamePool::intern(const string &name, const string **stored)
+{
+    uint64_t fingerprint = MurmurHash64A(name.data(), (int)name.length(), 0);
+    uint32_t id;
+    {
+        shared_lock<shared_mutex> reading(lock);
+        if (lookup(name, fingerprint, id))
+        {
+            if (stored != nullptr)
+                *stored = texts.get(id);
+            return id;
+        }
+    }
+    unique_lock<shared_mutex> writing(lock);
+    // Luồng khác có thể đã thêm name giữa hai lần khoá
+    if (lookup(name, fingerprint, id))
+    {
+        if (stored != nullptr)
+            *stored = texts.get(id);
+        return id;
+    }
+    id = (uint32_t)texts.size();
+    if (byFingerprint.containsKey(fingerprint))
+    {
+        if (collisions == nullptr)
+        {
+            collisions = new xMap<string, uint32_t>(&textHash);
+        }
+        collisions->put(name, id);
+    }
+    else
+    {
+        byFingerprint.put(fingerprint, id);
+    }
+    texts.add(new string(name));
+    if (stored != nullptr)
+        *stored = texts.get(id);
+    return id;
+}
+
+inline bool AttributeNamePool::find(const string &name, uint32_t &id) const
+{
+    uint64_t fingerprint = MurmurHash64A(name.data(), (int)name.length(), 0);
+    shared_lock<shared_mutex> reading(lock);
+    return lookup(name, fingerprint, id);
+}
+
+inline const string *AttributeNamePool::text(uint32_t id) const
+{
+    shared_lock<shared_mutex> reading(lock);
+    if (id >= (uint32_t)texts.size())
+    {
+        throw out_of_range("Attribute name id is invalid!");
+    }
+    return texts.get(id);
+}
+
+inline int AttributeNamePool::size() const
+{
+    shared_lock<shared_mutex> reading(lock);
+    return texts.size();
+}
+
+inline AttributeName::AttributeName(const string &name)
+{
+    nameId = AttributeNamePool::instance().intern(name, &text);
+}
+
 //////////////// -- -- -- -- -- --List1D Method Definitions-- -- -- -- -- --////////////////////////////////
 // List1D default constructor: creates an empty list.
 template <typename T>
@@ -203,6 +872,32 @@ inline List1D<T>::List1D(const List1D<T> &other)
         pList->add(other.get(i)); // Sao chép từng phần tử từ danh sách other
     }
 }
+
+template <typename T>
+inline List1D<T>::List1D(List1D<T> &&other)
+{
+    pList = other.pList;
+    other.pList = new XArrayList<T>();
+}
+/*
+ * Toán tử gán: Sao chép sâu danh sách other vào danh sách hiện tại
+ * @param other Danh sách nguồn
+ * @return Tham chiếu đến danh sách hiện tại
+ */
+template <typename T>
+inline List1D<T> &List1D<T>::operator=(const List1D<T> &other)
+{
+    if (this != &other)
+    {
+        pList->clear();
+        for (int i = 0; i < other.size(); i++)
+        {
+            pList->add(other.get(i));
+        }
+    }
+    return *this;
+}
+
 /*
  * Destructor: Giải phóng bộ nhớ đã cấp phát
  * Xóa đối tượng pList để tránh rò rỉ bộ nhớ
@@ -253,31 +948,8 @@ inline void List1D<T>::set(int index, T value)
         throw out_of_range("Index out of range");
     }
 
-    // Tạo một danh sách mới
-    IList<T> *newList = new XArrayList<T>();
-
-    // Sao chép tất cả các phần tử, thay thế phần tử tại vị trí index
-    for (int i = 0; i < pList->size(); i++)
-    {
-        if (i == index)
-        {
-            newList->add(value);
-        }
-        else
-        {
-            newList->add(pList->get(i));
-        }
-    }
-
-    // Xóa nội dung của pList và thêm lại từ newList
-    pList->clear();
-    for (int i = 0; i < newList->size(); i++)
-    {
-        pList->add(newList->get(i));
-    }
-
-    // Giải phóng bộ nhớ
-    delete newList;
+    // Ghi đè tại chỗ, O(1)
+    pList->get(index) = value;
 }
 /*
  * Thêm một phần tử vào cuối danh sách
@@ -289,6 +961,12 @@ inline void List1D<T>::add(const T &value)
     pList->add(value);
 }
 
+template <typename T>
+inline void List1D<T>::reserve(int capacity)
+{
+    pList->reserve(capacity);
+}
+
 /*
  * Tạo chuỗi biểu diễn của danh sách
  * @return Chuỗi biểu diễn theo định dạng: [e1, e2, e3, ..., en]
@@ -330,6 +1008,26 @@ inline void List1D<T>::removeAt(int index)
 {
     pList->removeAt(index);
 }
+
+template <typename T>
+inline void List1D<T>::compact(XArrayList<bool> &removed)
+{
+    int kept = 0;
+    for (int i = 0; i < pList->size(); i++)
+    {
+        if (!removed.get(i))
+        {
+            if (kept != i)
+                pList->get(kept) = pList->get(i);
+            kept++;
+        }
+    }
+    // Bỏ phần đuôi từ cuối lên để removeAt không phải dịch phần tử
+    while (pList->size() > kept)
+    {
+        pList->removeAt(pList->size() - 1);
+    }
+}
 // -------------------- Định nghĩa Phương thức List2D --------------------
 /*
  * Hàm khởi tạo mặc định: Tạo một ma trận rỗng
@@ -399,6 +1097,30 @@ List2D<T>::List2D(const List2D<T> &other)
         pMatrix->add(hangSaoChep);
     }
 }
+/*
+ * Toán tử gán: Sao chép sâu ma trận other vào ma trận hiện tại
+ * Giải phóng các hàng cũ trước khi sao chép các hàng mới
+ * @param other Ma trận nguồn
+ * @return Tham chiếu đến ma trận hiện tại
+ */
+template <typename T>
+List2D<T> &List2D<T>::operator=(const List2D<T> &other)
+{
+    if (this != &other)
+    {
+        for (int i = 0; i < pMatrix->size(); i++)
+        {
+            delete pMatrix->get(i);
+        }
+        pMatrix->clear();
+        for (int i = 0; i < other.rows(); i++)
+        {
+            pMatrix->add(new List1D<T>(other.getRow(i)));
+        }
+    }
+    return *this;
+}
+
 /*
  * Destructor: Giải phóng bộ nhớ đã cấp phát
  * Xóa từng danh sách hàng và sau đó xóa ma trận chính để tránh rò rỉ bộ nhớ
@@ -559,6 +1281,13 @@ string List2D<T>::toString() const
     return oss.str();
 }
 
+template <typename T>
+void List2D<T>::reserve(int numRows)
+{
+    // pMatrix luôn được tạo là XArrayList (xem các constructor)
+    static_cast<XArrayList<List1D<T> *> *>(pMatrix)->reserve(numRows);
+}
+
 // NEW: Adds a new row to the matrix.
 template <typename T>
 void List2D<T>::addRow(List1D<T> *row)
@@ -574,279 +1303,2207 @@ void List2D<T>::removeRow(int rowIndex)
         throw out_of_range("Row index is out of range!");
     delete pMatrix->removeAt(rowIndex);
 }
-//////////////// -- -- -- -- -- --InventoryManager Method Definitions-- -- -- -- -- --////////////////////////////////
-// Constructor mặc định: Khởi tạo các thành viên
-inline InventoryManager::InventoryManager()
+
+// Các hàng được giữ chỉ dời con trỏ, không sao chép nội dung
+template <typename T>
+void List2D<T>::compact(XArrayList<bool> &removed)
 {
-    // Không cần làm gì đặc biệt vì các thành viên attributesMatrix, productNames, quantities
-    // đã được khởi tạo mặc định bởi constructor của List2D và List1D
+    int kept = 0;
+    for (int i = 0; i < pMatrix->size(); i++)
+    {
+        if (removed.get(i))
+        {
+            delete pMatrix->get(i);
+            continue;
+        }
+        pMatrix->get(kept++) = pMatrix->get(i);
+    }
+    while (pMatrix->size() > kept)
+    {
+        pMatrix->removeAt(pMatrix->size() - 1);
+    }
 }
-// Constructor with parameters.
-inline InventoryManager::InventoryManager(const List2D<InventoryAttribute> &matrix,
-                                          const List1D<string> &names,
-                                          const List1D<int> &quantities)
-    : attributesMatrix(matrix), productNames(names), quantities(quantities) {}
+// -------------------- Định nghĩa Phương thức CowColumn --------------------
+template <typename T>
+inline CowColumn<T>::CowColumn() : spine(make_shared<Spine>()), count(0) {}
 
-inline InventoryManager::InventoryManager(const InventoryManager &other)
+template <typename T>
+inline CowColumn<T>::CowColumn(const List1D<T> &list) : CowColumn()
 {
-    // Sao chép từng thành viên từ đối tượng other
-    this->attributesMatrix = other.attributesMatrix;
-    this->productNames = other.productNames;
-    this->quantities = other.quantities;
+    reserve(list.size());
+    for (int i = 0; i < list.size(); i++)
+    {
+        add(list.get(i));
+    }
 }
 
-inline int InventoryManager::size() const
+template <typename T>
+inline const T &CowColumn<T>::get(int index) const
 {
-    // Trả về kích thước của productNames (có thể dùng attributesMatrix.rows() hoặc quantities.size())
-    return productNames.size();
+    if (index < 0 || index >= count)
+    {
+        throw out_of_range("Index out of range");
+    }
+    return spine->chunks.get(index / CHUNK_SIZE)->items[index % CHUNK_SIZE];
 }
-inline List1D<InventoryAttribute> InventoryManager::getProductAttributes(int index) const
+
+template <typename T>
+inline const T *CowColumn<T>::block(int index) const
 {
-    // Kiểm tra chỉ số hợp lệ: từ 0 đến size() - 1
-    if (index < 0 || index >= attributesMatrix.rows())
+    if (index < 0 || index >= count)
     {
-        throw out_of_range("Index is invalid!");
+        throw out_of_range("Index out of range");
     }
-    // Trả về hàng tại chỉ số index từ attributesMatrix
-    return attributesMatrix.getRow(index);
+    return spine->chunks.get(index / CHUNK_SIZE)->items + index % CHUNK_SIZE;
 }
-inline string InventoryManager::getProductName(int index) const
+
+template <typename T>
+inline typename CowColumn<T>::Spine &CowColumn<T>::writableSpine()
 {
-    // Kiểm tra chỉ số hợp lệ
-    if (index < 0 || index >= size())
+    if (!exclusive(spine))
     {
-        throw out_of_range("Index is invalid!");
+        spine = make_shared<Spine>(*spine);
     }
-    // Trả về tên sản phẩm tại index
-    return productNames.get(index);
+    return *spine;
 }
 
-inline int InventoryManager::getProductQuantity(int index) const
+template <typename T>
+inline typename CowColumn<T>::Chunk &CowColumn<T>::writableChunk(int chunkIndex)
 {
-    // Kiểm tra chỉ số hợp lệ
-    if (index < 0 || index >= quantities.size())
+    shared_ptr<Chunk> &chunk = writableSpine().chunks.get(chunkIndex);
+    if (!exclusive(chunk))
     {
-        throw out_of_range("Index is invalid!");
+        chunk = make_shared<Chunk>(*chunk);
     }
-    // Trả về số lượng tại index
-    return quantities.get(index);
+    return *chunk;
 }
 
-inline void InventoryManager::updateQuantity(int index, int newQuantity)
+// Khối cuối (ghi được) còn chỗ cho một phần tử mới
+template <typename T>
+inline typename CowColumn<T>::Chunk &CowColumn<T>::appendSlot()
 {
-    // Kiểm tra chỉ số hợp lệ
-    if (index < 0 || index >= quantities.size())
+    Spine &current = writableSpine();
+    if (count % CHUNK_SIZE == 0)
     {
-        throw out_of_range("Index is invalid!");
+        current.chunks.add(make_shared<Chunk>());
     }
-    // Cập nhật số lượng mới
-    quantities.set(index, newQuantity);
+    return writableChunk(current.chunks.size() - 1);
 }
 
-// Adds a new product.
-inline void InventoryManager::addProduct(const List1D<InventoryAttribute> &attributes, const string &name, int quantity)
+template <typename T>
+inline void CowColumn<T>::set(int index, const T &value)
 {
-    // Create a new List1D for attributes (copy).
-    List1D<InventoryAttribute> *newRow = new List1D<InventoryAttribute>(attributes);
-    // Use the public addRow method.
-    attributesMatrix.addRow(newRow);
-    productNames.add(name);
-    quantities.add(quantity);
+    if (index < 0 || index >= count)
+    {
+        throw out_of_range("Index out of range");
+    }
+    writableChunk(index / CHUNK_SIZE).items[index % CHUNK_SIZE] = value;
 }
 
-// Removes a product at the given index.
-inline void InventoryManager::removeProduct(int index)
+template <typename T>
+inline void CowColumn<T>::add(const T &value)
+{
+    Chunk &chunk = appendSlot();
+    new (chunk.items + chunk.count) T(value);
+    chunk.count++;
+    count++;
+}
+
+template <typename T>
+inline void CowColumn<T>::add(T &&value)
+{
+    Chunk &chunk = appendSlot();
+    new (chunk.items + chunk.count) T(std::move(value));
+    chunk.count++;
+    count++;
+}
+
+template <typename T>
+inline void CowColumn<T>::truncate(int newCount)
+{
+    Spine &current = writableSpine();
+    while (count > newCount)
+    {
+        Chunk &last = writableChunk(current.chunks.size() - 1);
+        last.items[--last.count].~T();
+        count--;
+        if (last.count == 0)
+        {
+            current.chunks.removeAt(current.chunks.size() - 1);
+        }
+    }
+}
+
+template <typename T>
+inline void CowColumn<T>::removeAt(int index)
+{
+    if (index < 0 || index >= count)
+    {
+        throw out_of_range("Index out of range");
+    }
+    for (int i = index; i < count - 1; i++)
+    {
+        writableChunk(i / CHUNK_SIZE).items[i % CHUNK_SIZE] = get(i + 1);
+    }
+    truncate(count - 1);
+}
+
+template <typename T>
+inline void CowColumn<T>::reserve(int capacity)
+{
+    writableSpine().chunks.reserve((capacity + CHUNK_SIZE - 1) / CHUNK_SIZE);
+}
+
+template <typename T>
+inline void CowColumn<T>::compact(XArrayList<bool> &removed)
+{
+    int first = 0;
+    while (first < count && !removed.get(first))
+    {
+        first++;
+    }
+    if (first == count)
+    {
+        return;
+    }
+    int kept = first;
+    for (int i = first + 1; i < count; i++)
+    {
+        if (!removed.get(i))
+        {
+            writableChunk(kept / CHUNK_SIZE).items[kept % CHUNK_SIZE] = get(i);
+            kept++;
+        }
+    }
+    truncate(kept);
+}
+
+template <typename T>
+inline List1D<T> CowColumn<T>::toList() const
+{
+    List1D<T> list;
+    list.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        list.add(get(i));
+    }
+    return list;
+}
+
+// -------------------- Định nghĩa Phương thức CowRows --------------------
+template <typename T>
+inline CowRows<T>::CowRows(const List2D<T> &matrix)
+{
+    items.reserve(matrix.rows());
+    for (int i = 0; i < matrix.rows(); i++)
+    {
+        addRow(new List1D<T>(matrix.getRow(i)));
+    }
+}
+
+template <typename T>
+inline List2D<T> CowRows<T>::toList2D() const
+{
+    List2D<T> matrix;
+    matrix.reserve(rows());
+    for (int i = 0; i < rows(); i++)
+    {
+        matrix.addRow(new List1D<T>(*items.get(i)));
+    }
+    return matrix;
+}
+
+//////////////// -- -- -- -- -- --ColumnarStore Method Definitions-- -- -- -- -- --////////////////////////////////
+inline ColumnarStore::ColumnarStore()
+    : rows(0), capacity(0), columns(nullptr), columnTotal(0), columnCapacity(0)
+{
+    cellStart.add(0);
+}
+
+inline ColumnarStore::ColumnarStore(const ColumnarStore &other)
+    : rows(0), capacity(0), columns(nullptr), columnTotal(0), columnCapacity(0)
+{
+    copyFrom(other);
+}
+
+inline ColumnarStore &ColumnarStore::operator=(const ColumnarStore &other)
+{
+    if (this != &other)
+    {
+        release();
+        copyFrom(other);
+    }
+    return *this;
+}
+
+inline ColumnarStore::~ColumnarStore()
+{
+    release();
+}
+
+// Cấp phát mảng mới newCapacity phần tử (khởi tạo mặc định), chép count phần tử đầu rồi giải phóng mảng cũ
+template <typename T>
+inline T *ColumnarStore::grow(T *array, int count, int newCapacity)
+{
+    T *result = new T[newCapacity]();
+    for (int i = 0; i < count; i++)
+    {
+        result[i] = array[i];
+    }
+    delete[] array;
+    return result;
+}
+
+inline void ColumnarStore::release()
+{
+    delete[] columns;
+    columns = nullptr;
+    quantityColumn = CowColumn<int>();
+    cellStart = CowColumn<int>();
+    cellColumns = CowColumn<int>();
+    rows = capacity = columnTotal = columnCapacity = 0;
+}
+
+// Các cột chỉ chia sẻ khối với other (xem CowColumn), không sao chép giá trị
+inline void ColumnarStore::copyFrom(const ColumnarStore &other)
+{
+    rows = other.rows;
+    capacity = other.capacity;
+    columnTotal = other.columnTotal;
+    columnCapacity = other.columnTotal;
+    quantityColumn = other.quantityColumn;
+    cellStart = other.cellStart;
+    cellColumns = other.cellColumns;
+    columns = grow<Column>(nullptr, 0, columnCapacity);
+    for (int c = 0; c < columnTotal; c++)
+    {
+        columns[c] = other.columns[c];
+    }
+    firstColumn = other.firstColumn;
+}
+
+inline void ColumnarStore::ensureRows(int count)
+{
+    if (count <= capacity)
+    {
+        return;
+    }
+    int newCapacity = (count + 63) / 64 * 64;
+    pad(quantityColumn, newCapacity);
+    for (int c = 0; c < columnTotal; c++)
+    {
+        pad(columns[c].values, newCapacity);
+        pad(columns[c].present, newCapacity / 64);
+    }
+    capacity = newCapacity;
+}
+
+inline void ColumnarStore::reserve(int rowCapacity)
+{
+    quantityColumn.reserve(rowCapacity);
+    cellStart.reserve(rowCapacity + 1);
+}
+
+// Cột giữ lần xuất hiện thứ occurrence (tính từ 0) của name trong một hàng, tạo mới nếu chưa có
+inline int ColumnarStore::columnFor(const AttributeName &name, int occurrence)
+{
+    int nameId = (int)name.id();
+    while (firstColumn.size() <= nameId)
+    {
+        firstColumn.add(-1);
+    }
+
+    int previous = -1;
+    int column = firstColumn.get(nameId);
+    for (int k = 0;; k++)
+    {
+        if (column == -1)
+        {
+            if (columnTotal == columnCapacity)
+            {
+                columnCapacity = columnCapacity < 8 ? 8 : columnCapacity * 2;
+                columns = grow(columns, columnTotal, columnCapacity);
+            }
+            column = columnTotal++;
+            columns[column].name = name;
+            columns[column].next = -1;
+            pad(columns[column].values, capacity);
+            pad(columns[column].present, capacity / 64);
+            if (previous == -1)
+                firstColumn.get(nameId) = column;
+            else
+                columns[previous].next = column;
+        }
+        if (k == occurrence)
+            return column;
+        previous = column;
+        column = columns[column].next;
+    }
+}
+
+inline void ColumnarStore::addRow(const List1D<InventoryAttribute> &attributes, int quantity)
+{
+    ensureRows(rows + 1);
+    int start = cellColumns.size();
+    for (int j = 0; j < attributes.size(); j++)
+    {
+        InventoryAttribute attribute = attributes.get(j);
+        // Số lần tên này đã xuất hiện trước đó trong cùng hàng
+        int occurrence = 0;
+        for (int k = start; k < cellColumns.size(); k++)
+        {
+            if (columns[cellColumns.get(k)].name == attribute.name)
+                occurrence++;
+        }
+        int column = columnFor(attribute.name, occurrence);
+        columns[column].values.set(rows, attribute.value);
+        assignBit(columns[column].present, rows, true);
+        cellColumns.add(column);
+    }
+    quantityColumn.set(rows, quantity);
+    rows++;
+    cellStart.add(cellColumns.size());
+}
+
+inline List1D<InventoryAttribute> ColumnarStore::getRow(int row) const
+{
+    if (row < 0 || row >= rows)
+    {
+        throw out_of_range("Index is invalid!");
+    }
+    List1D<InventoryAttribute> result;
+    int start = cellStart.get(row);
+    int end = cellStart.get(row + 1);
+    result.reserve(end - start);
+    for (int k = start; k < end; k++)
+    {
+        const Column &column = columns[cellColumns.get(k)];
+        result.add(InventoryAttribute(column.name, column.values.get(row)));
+    }
+    return result;
+}
+
+inline void ColumnarStore::removeRow(int row)
+{
+    if (row < 0 || row >= rows)
+    {
+        throw out_of_range("Index is invalid!");
+    }
+    XArrayList<bool> removed;
+    XArrayList<int> quantities;
+    removed.reserve(rows);
+    quantities.reserve(rows);
+    for (int r = 0; r < rows; r++)
+    {
+        removed.add(r == row);
+        quantities.add(quantityColumn.get(r));
+    }
+    compact(removed, quantities);
+}
+
+// Các hàng trước hàng bị xoá đầu tiên giữ nguyên vị trí; chỉ ghi những ô đổi giá trị (xem update) để các
+// khối không đổi vẫn được dùng chung với bản sao
+inline void ColumnarStore::compact(XArrayList<bool> &removed, XArrayList<int> &quantities)
+{
+    int first = 0;
+    while (first < rows && !removed.get(first))
+    {
+        update(quantityColumn, first, quantities.get(first));
+        first++;
+    }
+    if (first == rows)
+    {
+        return;
+    }
+
+    // Danh sách cột của từng hàng
+    int keptRows = first;
+    int keptCells = cellStart.get(first);
+    for (int r = first; r < rows; r++)
+    {
+        int start = cellStart.get(r);
+        int end = cellStart.get(r + 1);
+        if (removed.get(r))
+            continue;
+        update(cellStart, keptRows, keptCells);
+        for (int k = start; k < end; k++)
+        {
+            update(cellColumns, keptCells++, cellColumns.get(k));
+        }
+        update(quantityColumn, keptRows, quantities.get(r));
+        keptRows++;
+    }
+    update(cellStart, keptRows, keptCells);
+    cellStart.truncate(keptRows + 1);
+    cellColumns.truncate(keptCells);
+
+    // Mỗi cột dồn giá trị và bit có mặt trong một lượt; các hàng bỏ trống ở cuối bị xoá bit
+    for (int c = 0; c < columnTotal; c++)
+    {
+        Column &column = columns[c];
+        int kept = first;
+        for (int r = first; r < rows; r++)
+        {
+            if (removed.get(r))
+                continue;
+            update(column.values, kept, column.values.get(r));
+            assignBit(column.present, kept, testBit(column.present, r));
+            kept++;
+        }
+        for (int r = kept; r < rows; r++)
+        {
+            assignBit(column.present, r, false);
+        }
+    }
+    rows = keptRows;
+}
+
+#if defined(__AVX2__)
+inline uint64_t ColumnarStore::rangeMask(const Column &column, int word, double minValue, double maxValue) const
+{
+    const double *values = column.values.block(word * 64);
+    __m256d low = _mm256_set1_pd(minValue);
+    __m256d high = _mm256_set1_pd(maxValue);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i += 4)
+    {
+        __m256d v = _mm256_loadu_pd(values + i);
+        __m256d inside = _mm256_and_pd(_mm256_cmp_pd(v, low, _CMP_GE_OQ), _mm256_cmp_pd(v, high, _CMP_LE_OQ));
+        mask |= (uint64_t)_mm256_movemask_pd(inside) << i;
+    }
+    return mask;
+}
+
+inline uint64_t ColumnarStore::quantityMask(int word, int minQuantity) const
+{
+    const int *quantity = quantityColumn.block(word * 64);
+    __m256i floor = _mm256_set1_epi32(minQuantity);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i += 8)
+    {
+        // quantity >= minQuantity  <=>  !(minQuantity > quantity)
+        __m256i below = _mm256_cmpgt_epi32(floor, _mm256_loadu_si256((const __m256i *)(quantity + i)));
+        mask |= (uint64_t)(~_mm256_movemask_ps(_mm256_castsi256_ps(below)) & 0xFF) << i;
+    }
+    return mask;
+}
+#else
+inline uint64_t ColumnarStore::rangeMask(const Column &column, int word, double minValue, double maxValue) const
+{
+    const double *values = column.values.block(word * 64);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i++)
+    {
+        mask |= (uint64_t)(values[i] >= minValue && values[i] <= maxValue) << i;
+    }
+    return mask;
+}
+
+inline uint64_t ColumnarStore::quantityMask(int word, int minQuantity) const
+{
+    const int *quantity = quantityColumn.block(word * 64);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i++)
+    {
+        mask |= (uint64_t)(quantity[i] >= minQuantity) << i;
+    }
+    return mask;
+}
+#endif
+
+// Quét từng khối 64 hàng: OR các cột của name (lọc theo bit có mặt) rồi AND với điều kiện số lượng
+inline void ColumnarStore::filter(const string &name, double minValue, double maxValue, int minQuantity,
+                                  XArrayList<int> &matches) const
+{
+    uint32_t nameId;
+    if (!AttributeNamePool::instance().find(name, nameId) || (int)nameId >= firstColumn.size())
+    {
+        return;
+    }
+    int first = firstColumn.get((int)nameId);
+    int words = (rows + 63) / 64;
+    for (int w = 0; w < words; w++)
+    {
+        uint64_t hits = 0;
+        for (int c = first; c != -1; c = columns[c].next)
+        {
+            uint64_t present = columns[c].present.get(w);
+            if (present != 0)
+                hits |= present & rangeMask(columns[c], w, minValue, maxValue);
+        }
+        if (hits == 0)
+            continue;
+        hits &= quantityMask(w, minQuantity);
+        while (hits != 0)
+        {
+            matches.add(w * 64 + __builtin_ctzll(hits));
+            hits &= hits - 1;
+        }
+    }
+}
+
+inline bool ColumnarStore::rowInRange(int row, uint32_t nameId, double minValue, double maxValue) const
+{
+    if ((int)nameId >= firstColumn.size())
+    {
+        return false;
+    }
+    // Lần xuất hiện thứ k vắng mặt thì các lần sau cũng vắng mặt
+    for (int c = firstColumn.get((int)nameId); c != -1 && testBit(columns[c].present, row); c = columns[c].next)
+    {
+        double value = columns[c].values.get(row);
+        if (value >= minValue && value <= maxValue)
+            return true;
+    }
+    return false;
+}
+
+inline int ColumnarStore::estimateRows(uint32_t nameId, double minValue, double maxValue) const
+{
+    if ((int)nameId >= firstColumn.size() || firstColumn.get((int)nameId) == -1)
+    {
+        return 0;
+    }
+    const CowColumn<uint64_t> &present = columns[firstColumn.get((int)nameId)].present;
+    int having = 0;
+    for (int w = 0; w < (rows + 63) / 64; w++)
+    {
+        having += __builtin_popcountll(present.get(w));
+    }
+
+    int stride = rows / SAMPLE_ROWS + 1;
+    int sampled = 0;
+    int inRange = 0;
+    for (int r = 0; r < rows; r += stride)
+    {
+        if (testBit(present, r))
+        {
+            sampled++;
+            inRange += rowInRange(r, nameId, minValue, maxValue);
+        }
+    }
+    if (having == 0 || sampled == 0)
+    {
+        return having;
+    }
+    int estimate = (int)((long long)having * inRange / sampled);
+    return estimate > 0 ? estimate : 1;
+}
+
+//////////////// -- -- -- -- -- --InventoryManager Method Definitions-- -- -- -- -- --////////////////////////////////
+// Constructor mặc định: Khởi tạo các thành viên
+inline InventoryManager::InventoryManager()
+    : codec(nullptr), columns(nullptr), attributeIndexing(false), attributeIndexes(nullptr), nameIndex(nullptr),
+      dedupeOnInsert(false), productKeys(nullptr)
+{
+    // Không cần làm gì đặc biệt vì các thành viên attributesMatrix, productNames, quantities
+    // đã được khởi tạo mặc định bởi constructor của List2D và List1D
+}
+// Constructor with parameters.
+inline InventoryManager::InventoryManager(const List2D<InventoryAttribute> &matrix,
+                                          const List1D<string> &names,
+                                          const List1D<int> &quantities)
+    : attributesMatrix(matrix), productNames(names), quantities(quantities), codec(nullptr),
+      columns(nullptr), attributeIndexing(false), attributeIndexes(nullptr), nameIndex(nullptr),
+      dedupeOnInsert(false), productKeys(nullptr) {}
+
+inline InventoryManager::InventoryManager(const InventoryManager &other)
+    : codec(nullptr), columns(nullptr), attributeIndexing(false), attributeIndexes(nullptr), nameIndex(nullptr),
+      dedupeOnInsert(false), productKeys(nullptr)
+{
+    *this = other;
+}
+
+inline InventoryManager &InventoryManager::operator=(const InventoryManager &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    // Sao chép từng thành viên từ đối tượng other: các cột chỉ chia sẻ khối (O(1), xem CowColumn); chỉ mục
+    // phụ không được sao chép mà dựng lại khi cần
+    this->attributesMatrix = other.attributesMatrix;
+    this->productNames = other.productNames;
+    this->quantities = other.quantities;
+    this->codec = other.codec;
+    this->encodedRecords = other.encodedRecords;
+    this->decodeCache = other.decodeCache;
+    this->columns = other.columns;
+    this->attributeIndexing = other.attributeIndexing;
+    this->dedupeOnInsert = other.dedupeOnInsert;
+    clearAttributeIndexes();
+    clearNameIndex();
+    clearProductKeys();
+    return *this;
+}
+
+inline InventoryManager::~InventoryManager()
+{
+    clearAttributeIndexes();
+    clearNameIndex();
+    clearProductKeys();
+}
+
+inline int InventoryManager::size() const
 {
+    // Trả về kích thước của quantities (luôn có một phần tử mỗi sản phẩm, kể cả ở chế độ lưu nén)
+    return quantities.size();
+}
+inline List1D<InventoryAttribute> InventoryManager::getProductAttributes(int index) const
+{
+    // Kiểm tra chỉ số hợp lệ: từ 0 đến size() - 1
     if (index < 0 || index >= size())
+    {
         throw out_of_range("Index is invalid!");
-    // Remove the corresponding row using the public removeRow method.
-    attributesMatrix.removeRow(index);
-    productNames.removeAt(index);
+    }
+    if (codec != nullptr)
+    {
+        return decodeProduct(index).attributes;
+    }
+    if (columns != nullptr)
+    {
+        return columns->getRow(index);
+    }
+    // Trả về hàng tại chỉ số index từ attributesMatrix
+    return attributesMatrix.getRow(index);
+}
+inline string InventoryManager::getProductName(int index) const
+{
+    // Kiểm tra chỉ số hợp lệ
+    if (index < 0 || index >= size())
+    {
+        throw out_of_range("Index is invalid!");
+    }
+    if (codec != nullptr)
+    {
+        return decodeProduct(index).name;
+    }
+    // Trả về tên sản phẩm tại index
+    return productNames.get(index);
+}
+
+inline int InventoryManager::getProductQuantity(int index) const
+{
+    // Kiểm tra chỉ số hợp lệ
+    if (index < 0 || index >= quantities.size())
+    {
+        throw out_of_range("Index is invalid!");
+    }
+    // Trả về số lượng tại index
+    return quantities.get(index);
+}
+
+inline void InventoryManager::updateQuantity(int index, int newQuantity)
+{
+    // Kiểm tra chỉ số hợp lệ
+    if (index < 0 || index >= quantities.size())
+    {
+        throw out_of_range("Index is invalid!");
+    }
+    // Cập nhật số lượng mới
+    quantities.set(index, newQuantity);
+    if (columns != nullptr)
+    {
+        writableColumns().setQuantity(index, newQuantity);
+    }
+}
+
+// Adds a new product.
+inline void InventoryManager::addProduct(const List1D<InventoryAttribute> &attributes, const string &name, int quantity)
+{
+    if (dedupeOnInsert)
+    {
+        if (productKeys == nullptr)
+        {
+            productKeys = new ContentTable();
+            for (int i = 0; i < size(); i++)
+            {
+                productKeys->findOrInsert(productKey(getProductName(i), getProductAttributes(i)), i);
+            }
+        }
+        int existing = productKeys->findOrInsert(productKey(name, attributes), size());
+        if (existing >= 0)
+        {
+            quantities.set(existing, quantities.get(existing) + quantity);
+            if (columns != nullptr)
+            {
+                writableColumns().setQuantity(existing, quantities.get(existing));
+            }
+            return;
+        }
+    }
+    indexProduct(size(), attributes);
+    if (nameIndex != nullptr)
+    {
+        productsNamed(name, true)->add(size());
+    }
+    if (codec != nullptr)
+    {
+        encodedRecords.add(codec->encodeRecord(attributes, name));
+        quantities.add(quantity);
+        return;
+    }
+    if (columns != nullptr)
+    {
+        writableColumns().addRow(attributes, quantity);
+        productNames.add(name);
+        quantities.add(quantity);
+        return;
+    }
+    // Create a new List1D for attributes (copy).
+    List1D<InventoryAttribute> *newRow = new List1D<InventoryAttribute>(attributes);
+    // Use the public addRow method.
+    attributesMatrix.addRow(newRow);
+    productNames.add(name);
+    quantities.add(quantity);
+}
+
+// Removes a product at the given index.
+inline void InventoryManager::removeProduct(int index)
+{
+    if (index < 0 || index >= size())
+        throw out_of_range("Index is invalid!");
+    unindexProduct(index);
+    clearProductKeys();
+    if (nameIndex != nullptr)
+    {
+        DLinkedList<XArrayList<int> *> lists = nameIndex->values();
+        for (XArrayList<int> *indices : lists)
+        {
+            removeFromIndexList(*indices, index);
+        }
+    }
+    if (codec != nullptr)
+    {
+        // Các chỉ số phía sau bị dịch, bộ đệm giải mã không còn đúng
+        encodedRecords.removeAt(index);
+        quantities.removeAt(index);
+        resetDecodeCache(decodeCache.size());
+        return;
+    }
+    if (columns != nullptr)
+    {
+        writableColumns().removeRow(index);
+        productNames.removeAt(index);
+        quantities.removeAt(index);
+        return;
+    }
+    // Remove the corresponding row using the public removeRow method.
+    attributesMatrix.removeRow(index);
+    productNames.removeAt(index);
     quantities.removeAt(index);
 }
 
-inline List1D<string> InventoryManager::query(
-    string attributeName,
-    const double &minValue,
-    const double &maxValue,
-    int minQuantity,
-    bool ascending) const
+inline void InventoryManager::addProducts(const List2D<InventoryAttribute> &attributes,
+                                          const List1D<string> &names,
+                                          const List1D<int> &newQuantities)
+{
+    int count = names.size();
+    if (attributes.rows() != count || newQuantities.size() != count)
+    {
+        throw invalid_argument("Batch lists must have the same size");
+    }
+    if (count == 0)
+    {
+        return;
+    }
+    // Chỉ mục phụ được dựng lại lười thay vì chèn từng hàng
+    clearAttributeIndexes();
+    clearNameIndex();
+    clearProductKeys();
+
+    quantities.reserve(size() + count);
+    if (codec != nullptr)
+    {
+        encodedRecords.reserve(encodedRecords.size() + count);
+    }
+    else
+    {
+        productNames.reserve(productNames.size() + count);
+        if (columns != nullptr)
+            writableColumns().reserve(columns->size() + count);
+        else
+            attributesMatrix.reserve(attributesMatrix.rows() + count);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        List1D<InventoryAttribute> row = attributes.getRow(i);
+        if (codec != nullptr)
+        {
+            encodedRecords.add(codec->encodeRecord(row, names.get(i)));
+        }
+        else
+        {
+            if (columns != nullptr)
+                writableColumns().addRow(row, newQuantities.get(i));
+            else
+                attributesMatrix.addRow(new List1D<InventoryAttribute>(std::move(row)));
+            productNames.add(names.get(i));
+        }
+        quantities.add(newQuantities.get(i));
+    }
+
+    // Chế độ gộp khi thêm: gộp cả lô một lần thay vì tra từng hàng
+    if (dedupeOnInsert)
+    {
+        removeDuplicates();
+    }
+}
+
+inline void InventoryManager::removeProducts(const List1D<int> &indices)
+{
+    int n = size();
+    for (int k = 0; k < indices.size(); k++)
+    {
+        if (indices.get(k) < 0 || indices.get(k) >= n)
+            throw out_of_range("Index is invalid!");
+    }
+    if (indices.size() == 0)
+    {
+        return;
+    }
+    XArrayList<bool> removed;
+    XArrayList<int> kept;
+    removed.reserve(n);
+    kept.reserve(n);
+    for (int i = 0; i < n; i++)
+    {
+        removed.add(false);
+        kept.add(quantities.get(i));
+    }
+    for (int k = 0; k < indices.size(); k++)
+    {
+        removed.get(indices.get(k)) = true;
+    }
+    compactProducts(removed, kept);
+}
+
+inline void InventoryManager::updateQuantities(const List1D<int> &indices, const List1D<int> &newQuantities)
+{
+    if (indices.size() != newQuantities.size())
+    {
+        throw invalid_argument("Batch lists must have the same size");
+    }
+    for (int k = 0; k < indices.size(); k++)
+    {
+        if (indices.get(k) < 0 || indices.get(k) >= size())
+            throw out_of_range("Index is invalid!");
+    }
+    // Số lượng không nằm trong chỉ mục phụ nào nên không có gì phải huỷ
+    for (int k = 0; k < indices.size(); k++)
+    {
+        quantities.set(indices.get(k), newQuantities.get(k));
+        if (columns != nullptr)
+        {
+            writableColumns().setQuantity(indices.get(k), newQuantities.get(k));
+        }
+    }
+}
+
+inline void InventoryManager::collectMatches(
+    const string &attributeName,
+    const double &minValue,
+    const double &maxValue,
+    int minQuantity,
+    XArrayList<string> &matchedProducts) const
+{
+    if (attributeIndexing)
+    {
+        // Biên NaN không khớp giá trị nào (như khi quét hàng/cột), nhưng sẽ làm lệch tìm nhị phân
+        if (isnan(minValue) || isnan(maxValue))
+        {
+            return;
+        }
+        // Tìm nhị phân vị trí đầu tiên có giá trị >= minValue rồi duyệt tới khi vượt maxValue
+        AttributeIndex *found = attributeIndex(attributeName);
+        if (found == nullptr)
+        {
+            return;
+        }
+        AttributeIndex &index = *found;
+        int low = 0;
+        int high = index.size();
+        while (low < high)
+        {
+            int mid = low + (high - low) / 2;
+            if (index.get(mid).value < minValue)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        // Một sản phẩm có thể có nhiều thuộc tính cùng tên trong khoảng: lấy chỉ số tăng dần và bỏ trùng
+        Heap<int> products;
+        for (int p = low; p < index.size() && index.get(p).value <= maxValue; p++)
+        {
+            int product = index.get(p).product;
+            if (quantities.get(product) >= minQuantity)
+                products.push(product);
+        }
+        int previous = -1;
+        while (!products.empty())
+        {
+            int product = products.pop();
+            if (product != previous)
+                matchedProducts.add(getProductName(product));
+            previous = product;
+        }
+        return;
+    }
+
+    // Chế độ lưu theo cột: lọc trên các cột giá trị và số lượng
+    if (columns != nullptr)
+    {
+        XArrayList<int> rows;
+        columns->filter(attributeName, minValue, maxValue, minQuantity, rows);
+        matchedProducts.reserve(rows.size());
+        for (int i = 0; i < rows.size(); i++)
+        {
+            matchedProducts.add(productNames.get(rows.get(i)));
+        }
+        return;
+    }
+
+    // Tên chưa từng được intern thì không sản phẩm nào có; so khớp bên dưới là so sánh mã
+    uint32_t nameId;
+    if (!AttributeNamePool::instance().find(attributeName, nameId))
+    {
+        return;
+    }
+
+    // Chế độ lưu nén: mã hoá tên thuộc tính một lần rồi so khớp trực tiếp trên bản ghi nén
+    string key;
+    if (codec != nullptr)
+    {
+        key = codec->encodeAttributeKey(attributeName);
+    }
+
+    // Duyệt qua từng sản phẩm trong kho
+    for (int i = 0; i < size(); i++)
+    {
+        // Kiểm tra số lượng tồn kho
+        if (quantities.get(i) < minQuantity)
+            continue;
+
+        if (codec != nullptr)
+        {
+            int matched = codec->matchAttribute(encodedRecords.get(i), key, minValue, maxValue);
+            if (matched == 0)
+                continue;
+            if (matched > 0)
+            {
+                matchedProducts.add(getProductName(i));
+                continue;
+            }
+        }
+
+        // Lấy danh sách thuộc tính của sản phẩm (ở chế độ thường đọc thẳng dòng bất biến, không sao chép)
+        List1D<InventoryAttribute> decoded;
+        if (codec != nullptr)
+            decoded = getProductAttributes(i);
+        const List1D<InventoryAttribute> &productAttributes =
+            codec != nullptr ? decoded : attributesMatrix.row(i);
+
+        // Duyệt qua từng thuộc tính để tìm tên trùng khớp
+        for (int j = 0; j < productAttributes.size(); j++)
+        {
+            InventoryAttribute attribute = productAttributes.get(j);
+
+            // Kiểm tra tên thuộc tính và giá trị
+            if (attribute.name.id() == nameId &&
+                attribute.value >= minValue &&
+                attribute.value <= maxValue)
+            {
+                matchedProducts.add(getProductName(i));
+                break; // Tìm thấy thuộc tính phù hợp, chuyển sang sản phẩm tiếp theo
+            }
+        }
+    }
+}
+
+inline List1D<string> InventoryManager::query(
+    string attributeName,
+    const double &minValue,
+    const double &maxValue,
+    int minQuantity,
+    bool ascending) const
+{
+    XArrayList<string> matches;
+    collectMatches(attributeName, minValue, maxValue, minQuantity, matches);
+    return orderNames(matches, ascending);
+}
+
+// Sắp xếp tên bằng heap: O(n log n)
+inline List1D<string> InventoryManager::orderNames(XArrayList<string> &names, bool ascending)
+{
+    Heap<string> ordered(ascending ? &nameAscending : &nameDescending);
+    for (int i = 0; i < names.size(); i++)
+    {
+        ordered.push(names.get(i));
+    }
+    List1D<string> matchedProducts;
+    matchedProducts.reserve(names.size());
+    while (!ordered.empty())
+    {
+        matchedProducts.add(ordered.pop());
+    }
+    return matchedProducts;
+}
+
+inline List1D<string> InventoryManager::queryPage(
+    string attributeName,
+    const double &minValue,
+    const double &maxValue,
+    int minQuantity,
+    bool ascending,
+    int offset,
+    int limit) const
+{
+    if (offset < 0 || limit < 0)
+    {
+        throw std::invalid_argument("Offset and limit must be non-negative");
+    }
+    List1D<string> page;
+    if (limit == 0)
+    {
+        return page;
+    }
+    XArrayList<string> matches;
+    collectMatches(attributeName, minValue, maxValue, minQuantity, matches);
+    long keep = (long)offset + limit;
+    if (keep > matches.size())
+    {
+        keep = matches.size();
+    }
+    if (offset >= keep)
+    {
+        return page;
+    }
+
+    // Heap ngược thứ tự: đỉnh là tên tệ nhất trong số keep tên đang giữ, bị đẩy ra khi có tên tốt hơn
+    Heap<string> best(ascending ? &nameDescending : &nameAscending);
+    for (int i = 0; i < matches.size(); i++)
+    {
+        string &name = matches.get(i);
+        if (best.size() < keep)
+        {
+            best.push(name);
+        }
+        else if ((ascending ? name.compare(best.peek()) : best.peek().compare(name)) < 0)
+        {
+            best.pop();
+            best.push(name);
+        }
+    }
+    // Lấy ra từ tên tệ nhất, đặt ngược vào mảng rồi bỏ offset tên đầu
+    XArrayList<string> ordered;
+    ordered.reserve((int)keep);
+    for (int i = 0; i < keep; i++)
+    {
+        ordered.add(string());
+    }
+    for (int i = (int)keep - 1; i >= 0; i--)
+    {
+        ordered.get(i) = best.pop();
+    }
+    page.reserve((int)keep - offset);
+    for (int i = offset; i < keep; i++)
+    {
+        page.add(ordered.get(i));
+    }
+    return page;
+}
+
+inline List1D<string> InventoryManager::query(const List1D<AttributeRange> &ranges, int minQuantity,
+                                              bool ascending) const
+{
+    XArrayList<int> rows;
+    collectMatches(ranges, minQuantity, rows);
+    XArrayList<string> matches;
+    matches.reserve(rows.size());
+    for (int k = 0; k < rows.size(); k++)
+    {
+        matches.add(getProductName(rows.get(k)));
+    }
+    return orderNames(matches, ascending);
+}
+
+inline int InventoryManager::indexBound(AttributeIndex &index, double value, bool after)
+{
+    int low = 0;
+    int high = index.size();
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        double entry = index.get(mid).value;
+        if (entry < value || (after && entry == value))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+inline bool InventoryManager::attributesInRange(const List1D<InventoryAttribute> &attributes, const RangePlan &plan)
+{
+    for (int j = 0; j < attributes.size(); j++)
+    {
+        InventoryAttribute attribute = attributes.get(j);
+        if (attribute.name.id() == plan.nameId &&
+            attribute.value >= plan.range->minValue &&
+            attribute.value <= plan.range->maxValue)
+            return true;
+    }
+    return false;
+}
+
+inline bool InventoryManager::rowInRange(int row, const RangePlan &plan) const
+{
+    if (codec != nullptr)
+    {
+        int matched = codec->matchAttribute(encodedRecords.get(row), plan.key, plan.range->minValue, plan.range->maxValue);
+        if (matched >= 0)
+            return matched > 0;
+        return attributesInRange(decodeProduct(row).attributes, plan);
+    }
+    if (columns != nullptr)
+    {
+        return columns->rowInRange(row, plan.nameId, plan.range->minValue, plan.range->maxValue);
+    }
+    return attributesInRange(attributesMatrix.row(row), plan);
+}
+
+inline void InventoryManager::collectMatches(const List1D<AttributeRange> &ranges, int minQuantity,
+                                             XArrayList<int> &rows) const
+{
+    int n = size();
+    int count = ranges.size();
+    unique_ptr<AttributeRange[]> items(new AttributeRange[count > 0 ? count : 1]);
+    unique_ptr<RangePlan[]> plans(new RangePlan[count > 0 ? count : 1]);
+
+    // Lập kế hoạch: ước lượng từng vế; vế chắc chắn rỗng (biên NaN, tên chưa từng intern, khoảng trống trên
+    // chỉ mục, không hàng nào có tên) làm cả truy vấn rỗng
+    for (int p = 0; p < count; p++)
+    {
+        items[p] = ranges.get(p);
+        RangePlan &plan = plans[p];
+        plan.range = &items[p];
+        plan.index = nullptr;
+        plan.first = plan.last = 0;
+        if (isnan(items[p].minValue) || isnan(items[p].maxValue))
+            return;
+        if (!AttributeNamePool::instance().find(items[p].name, plan.nameId))
+            return;
+        if (attributeIndexing)
+        {
+            plan.index = attributeIndex(items[p].name);
+            plan.first = indexBound(*plan.index, items[p].minValue, false);
+            plan.last = indexBound(*plan.index, items[p].maxValue, true);
+            plan.estimate = plan.last > plan.first ? plan.last - plan.first : 0;
+        }
+        else if (columns != nullptr)
+        {
+            plan.estimate = columns->estimateRows(plan.nameId, items[p].minValue, items[p].maxValue);
+        }
+        else
+        {
+            plan.estimate = n; // quét hàng: không có thống kê
+        }
+        if (plan.estimate == 0)
+            return;
+        if (codec != nullptr)
+            plan.key = codec->encodeAttributeKey(items[p].name);
+    }
+    // Sắp các vế tăng dần theo ước lượng (số vế nhỏ: chèn trực tiếp)
+    for (int p = 1; p < count; p++)
+    {
+        for (int q = p; q > 0 && plans[q].estimate < plans[q - 1].estimate; q--)
+            swap(plans[q], plans[q - 1]);
+    }
+
+    // Không có chỉ mục hay cột nào để bắt đầu: một lượt quét kiểm tra mọi vế trên từng hàng
+    if (count == 0 || (plans[0].index == nullptr && columns == nullptr))
+    {
+        for (int i = 0; i < n; i++)
+        {
+            if (quantities.get(i) < minQuantity)
+                continue;
+            int p = 0;
+            while (p < count && rowInRange(i, plans[p]))
+                p++;
+            if (p == count)
+                rows.add(i);
+        }
+        return;
+    }
+
+    // Tập ứng viên từ vế chọn lọc nhất. marks là bitmap theo chỉ số sản phẩm, luôn được xoá về 0 sau mỗi lần
+    // dùng (chỉ xoá các bit đã đặt) nên chỉ cấp phát một lần
+    unique_ptr<uint64_t[]> marks;
+    if (plans[0].index != nullptr)
+    {
+        marks.reset(new uint64_t[(n + 63) / 64]());
+        AttributeIndex &index = *plans[0].index;
+        for (int e = plans[0].first; e < plans[0].last; e++)
+        {
+            int product = index.get(e).product;
+            uint64_t bit = 1ULL << (product & 63);
+            if ((marks[product >> 6] & bit) == 0 && quantities.get(product) >= minQuantity)
+            {
+                marks[product >> 6] |= bit;
+                rows.add(product);
+            }
+        }
+        for (int k = 0; k < rows.size(); k++)
+            marks[rows.get(k) >> 6] = 0;
+    }
+    else
+    {
+        columns->filter(plans[0].range->name, plans[0].range->minValue, plans[0].range->maxValue, minQuantity, rows);
+    }
+
+    // Các vế còn lại: giao với bitmap dựng từ khoảng trên chỉ mục nếu khoảng đó nhỏ hơn chi phí kiểm tra
+    // trực tiếp các ứng viên, ngược lại kiểm tra trực tiếp từng ứng viên
+    for (int p = 1; p < count && rows.size() > 0; p++)
+    {
+        RangePlan &plan = plans[p];
+        int kept = 0;
+        if (plan.index != nullptr && plan.estimate < rows.size() * ROW_CHECK_COST)
+        {
+            AttributeIndex &index = *plan.index;
+            for (int e = plan.first; e < plan.last; e++)
+            {
+                int product = index.get(e).product;
+                marks[product >> 6] |= 1ULL << (product & 63);
+            }
+            for (int k = 0; k < rows.size(); k++)
+            {
+                int product = rows.get(k);
+                if ((marks[product >> 6] >> (product & 63)) & 1ULL)
+                    rows.get(kept++) = product;
+            }
+            for (int e = plan.first; e < plan.last; e++)
+                marks[index.get(e).product >> 6] = 0;
+        }
+        else
+        {
+            for (int k = 0; k < rows.size(); k++)
+            {
+                if (rowInRange(rows.get(k), plan))
+                    rows.get(kept++) = rows.get(k);
+            }
+        }
+        while (rows.size() > kept)
+            rows.removeAt(rows.size() - 1);
+    }
+}
+
+inline void InventoryManager::removeDuplicates()
+{
+    // Mỗi sản phẩm được lấy khoá nội dung đúng một lần; bảng băm khoá -> chỉ số bản xuất hiện sớm
+    // nhất gom số lượng các bản trùng, sau đó các bản trùng bị xoá trong một lượt
+    int n = size();
+    XArrayList<bool> removed;
+    XArrayList<int> totals;
+    removed.reserve(n);
+    totals.reserve(n);
+    ContentTable first;
+    bool anyRemoved = false;
+    for (int i = 0; i < n; i++)
+    {
+        int earliest = first.findOrInsert(productKey(getProductName(i), getProductAttributes(i)), i);
+        totals.add(quantities.get(i));
+        removed.add(earliest >= 0);
+        if (earliest >= 0)
+        {
+            totals.get(earliest) += quantities.get(i);
+            anyRemoved = true;
+        }
+    }
+    if (anyRemoved)
+    {
+        compactProducts(removed, totals);
+    }
+}
+
+inline InventoryManager InventoryManager::merge(const InventoryManager &inv1, const InventoryManager &inv2)
+{
+    InventoryManager result;
+    int total = inv1.size() + inv2.size();
+    result.attributesMatrix.reserve(total);
+    result.productNames.reserve(total);
+    XArrayList<int> totals;
+    totals.reserve(total);
+
+    // Khoá nội dung -> vị trí trong kết quả
+    ContentTable positions;
+    const InventoryManager *sources[2] = {&inv1, &inv2};
+    for (int s = 0; s < 2; s++)
+    {
+        const InventoryManager &source = *sources[s];
+        for (int i = 0; i < source.size(); i++)
+        {
+            List1D<InventoryAttribute> attributes = source.getProductAttributes(i);
+            string name = source.getProductName(i);
+            int position = positions.findOrInsert(productKey(name, attributes), totals.size());
+            if (position >= 0)
+            {
+                totals.get(position) += source.quantities.get(i);
+                continue;
+            }
+            // Hàng vừa sao ra được chuyển thẳng vào kết quả, không sao chép lần hai
+            result.attributesMatrix.addRow(new List1D<InventoryAttribute>(std::move(attributes)));
+            result.productNames.add(name);
+            totals.add(source.quantities.get(i));
+        }
+    }
+    result.quantities.reserve(totals.size());
+    for (int i = 0; i < totals.size(); i++)
+    {
+        result.quantities.add(totals.get(i));
+    }
+
+    result.attributeIndexing = inv1.attributeIndexing;
+    result.dedupeOnInsert = inv1.dedupeOnInsert;
+    if (inv1.codec != nullptr)
+    {
+        result.enableCompressedStorage(inv1.codec, inv1.decodeCache.size());
+    }
+    if (inv1.columns != nullptr)
+    {
+        result.enableColumnarStorage();
+    }
+    return result;
+}
+
+inline void InventoryManager::split(InventoryManager &section1, InventoryManager &section2, double ratio) const
+{
+    int total = size();
+    int size1 = (total * ratio + (total * ratio > 0)); // Làm tròn lên
+    int size2 = total - size1;
+    section1 = InventoryManager();
+    section2 = InventoryManager();
+    for (int i = 0; i < size1; i++)
+    {
+        section1.addProduct(getProductAttributes(i), getProductName(i), getProductQuantity(i));
+    }
+    for (int i = size1; i < total; i++)
+    {
+        section2.addProduct(getProductAttributes(i), getProductName(i), getProductQuantity(i));
+    }
+}
+
+inline List2D<InventoryAttribute> InventoryManager::getAttributesMatrix() const
+{
+    if (codec != nullptr || columns != nullptr)
+    {
+        List2D<InventoryAttribute> matrix;
+        matrix.reserve(size());
+        for (int i = 0; i < size(); i++)
+        {
+            matrix.addRow(new List1D<InventoryAttribute>(getProductAttributes(i)));
+        }
+        return matrix;
+    }
+    return attributesMatrix.toList2D();
+}
+
+inline List1D<string> InventoryManager::getProductNames() const
+{
+    if (codec != nullptr)
+    {
+        List1D<string> names;
+        names.reserve(size());
+        for (int i = 0; i < size(); i++)
+        {
+            names.add(getProductName(i));
+        }
+        return names;
+    }
+    return productNames.toList();
+}
+
+inline List1D<int> InventoryManager::getQuantities() const
+{
+    return quantities.toList();
+}
+inline string InventoryManager::toString() const
+{
+    stringstream ss;
+    ss << "InventoryManager[" << endl;
+
+    // AttributesMatrix
+    ss << "  AttributesMatrix: [";
+    for (int i = 0; i < size(); i++)
+    {
+        ss << "[";
+        List1D<InventoryAttribute> attributeRow = getProductAttributes(i);
+        bool firstAttr = true;
+
+        for (int j = 0; j < attributeRow.size(); j++)
+        {
+            if (!firstAttr)
+                ss << ", ";
+            InventoryAttribute attr = attributeRow.get(j);
+            ss << attr.name << ": ";
+            // Định dạng số với 6 chữ số thập phân
+            ss << fixed << setprecision(6) << attr.value;
+            firstAttr = false;
+        }
+
+        ss << "]";
+        if (i < size() - 1)
+            ss << ", ";
+    }
+    ss << "]," << endl;
+
+    // ProductNames
+    ss << "  ProductNames: [";
+    for (int i = 0; i < size(); i++)
+    {
+        ss << getProductName(i);
+        if (i < size() - 1)
+            ss << ", ";
+    }
+    ss << "]," << endl;
+
+    // Quantities
+    ss << "  Quantities: [";
+    for (int i = 0; i < quantities.size(); i++)
+    {
+        ss << quantities.get(i);
+        if (i < quantities.size() - 1)
+            ss << ", ";
+    }
+    ss << "]" << endl;
+
+    ss << "]";
+    return ss.str();
+}
+
+// -------------------- Inventory record lines --------------------
+inline bool parseInventoryRecord(const char *first, const char *last, char delimiter, string &name, int &quantity,
+                                 List1D<InventoryAttribute> &attributes)
+{
+    // Bỏ '\r' cuối dòng của tệp CRLF
+    if (last > first && *(last - 1) == '\r')
+    {
+        last--;
+    }
+    if (first == last)
+    {
+        return false;
+    }
+
+    int field = 0;
+    const char *start = first;
+    while (start <= last)
+    {
+        const char *end = start;
+        while (end < last && *end != delimiter)
+        {
+            end++;
+        }
+
+        if (field == 0)
+        {
+            name.assign(start, end);
+        }
+        else if (field == 1)
+        {
+            // strtol/strtod dừng ở dấu phân cách hoặc '\n' nên không đọc sang trường khác
+            char *stop = nullptr;
+            long value = start < end ? strtol(start, &stop, 10) : 0;
+            if (start == end || stop != end || value < INT_MIN || value > INT_MAX)
+            {
+                return false;
+            }
+            quantity = (int)value;
+        }
+        else
+        {
+            const char *eq = start;
+            while (eq < end && *eq != '=')
+            {
+                eq++;
+            }
+            if (eq == end || eq == start || eq + 1 == end)
+            {
+                return false;
+            }
+            char *stop = nullptr;
+            double value = strtod(eq + 1, &stop);
+            if (stop != end)
+            {
+                return false;
+            }
+            attributes.add(InventoryAttribute(string(start, eq), value));
+        }
+
+        field++;
+        start = end + 1;
+    }
+    return field >= 2;
+}
+
+inline bool parseInventoryRecord(const string &line, char delimiter, string &name, int &quantity,
+                                 List1D<InventoryAttribute> &attributes)
+{
+    List1D<InventoryAttribute> parsed;
+    const char *first = line.c_str();
+    if (!parseInventoryRecord(first, first + line.length(), delimiter, name, quantity, parsed))
+    {
+        return false;
+    }
+    attributes = parsed;
+    return true;
+}
+
+inline string formatExactValue(double value)
+{
+    char text[32];
+    for (int precision = 15; precision <= 17; precision++)
+    {
+        snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (strtod(text, nullptr) == value)
+        {
+            break;
+        }
+    }
+    return text;
+}
+
+inline string formatInventoryRecord(const string &name, int quantity, const List1D<InventoryAttribute> &attributes,
+                                    char delimiter)
+{
+    ostringstream oss;
+    oss << name << delimiter << quantity;
+    for (int i = 0; i < attributes.size(); i++)
+    {
+        InventoryAttribute attr = attributes.get(i);
+        oss << delimiter << attr.name << '=' << formatExactValue(attr.value);
+    }
+    return oss.str();
+}
+
+inline int InventoryManager::loadFromFile(const string &path, char delimiter, int threadCount)
 {
-    List1D<string> matchedProducts;
+    ifstream file(path.c_str(), ios::binary);
+    if (!file)
+    {
+        return -1;
+    }
+    string content((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    file.close();
 
-    // Duyệt qua từng sản phẩm trong kho
-    for (int i = 0; i < size(); i++)
+    // Chia tệp thành các đoạn gần bằng nhau, mỗi ranh giới được đẩy tới sau ký tự '\n' kế tiếp.
+    // Đoạn quá nhỏ không đáng tạo luồng riêng
+    const size_t MIN_CHUNK_BYTES = 1 << 16;
+    if (threadCount <= 0)
     {
-        // Kiểm tra số lượng tồn kho
-        if (quantities.get(i) < minQuantity)
-            continue;
+        threadCount = (int)thread::hardware_concurrency();
+    }
+    size_t maxChunks = content.length() / MIN_CHUNK_BYTES + 1;
+    int chunks = threadCount < 1 ? 1 : threadCount;
+    if ((size_t)chunks > maxChunks)
+    {
+        chunks = (int)maxChunks;
+    }
+    XArrayList<size_t> bounds;
+    bounds.add(0);
+    for (int c = 1; c < chunks; c++)
+    {
+        size_t cut = content.length() / chunks * c;
+        if (cut < bounds.get(bounds.size() - 1))
+        {
+            cut = bounds.get(bounds.size() - 1);
+        }
+        size_t newline = content.find('\n', cut);
+        cut = newline == string::npos ? content.length() : newline + 1;
+        bounds.add(cut);
+    }
+    bounds.add(content.length());
 
-        // Lấy danh sách thuộc tính của sản phẩm
-        List1D<InventoryAttribute> productAttributes =
-            attributesMatrix.getRow(i);
-        bool foundMatchingAttribute = false;
+    // Kết quả riêng của từng đoạn, không dùng chung nên các luồng không cần khoá. Hàng chưa được
+    // chuyển vào kho (con trỏ khác null) thuộc về đoạn và được giải phóng cùng nó
+    struct ChunkResult
+    {
+        XArrayList<List1D<InventoryAttribute> *> rows;
+        XArrayList<string> names;
+        XArrayList<int> quantities;
+        exception_ptr failure;
 
-        // Duyệt qua từng thuộc tính để tìm tên trùng khớp
-        for (int j = 0; j < productAttributes.size(); j++)
+        ~ChunkResult()
         {
-            InventoryAttribute attribute = productAttributes.get(j);
-
-            // Kiểm tra tên thuộc tính và giá trị
-            if (attribute.name == attributeName &&
-                attribute.value >= minValue &&
-                attribute.value <= maxValue)
+            for (int r = 0; r < rows.size(); r++)
             {
-                matchedProducts.add(productNames.get(i));
-                break; // Tìm thấy thuộc tính phù hợp, chuyển sang sản phẩm tiếp theo
+                delete rows.get(r);
             }
         }
-    }
+    };
+    unique_ptr<ChunkResult[]> results(new ChunkResult[chunks]);
 
-    // Sắp xếp kết quả
-    for (int i = 0; i < matchedProducts.size() - 1; i++)
+    auto parseChunk = [&](int c)
     {
-        for (int j = 0; j < matchedProducts.size() - i - 1; j++)
+        ChunkResult &result = results[c];
+        try
+        {
+            const char *p = content.data() + bounds.get(c);
+            const char *chunkEnd = content.data() + bounds.get(c + 1);
+            string name;
+            int quantity = 0;
+            while (p < chunkEnd)
+            {
+                const char *lineEnd = p;
+                int fields = 1;
+                while (lineEnd < chunkEnd && *lineEnd != '\n')
+                {
+                    fields += (*lineEnd == delimiter);
+                    lineEnd++;
+                }
+
+                unique_ptr<List1D<InventoryAttribute>> row(new List1D<InventoryAttribute>());
+                row->reserve(fields > 2 ? fields - 2 : 0);
+                if (parseInventoryRecord(p, lineEnd, delimiter, name, quantity, *row))
+                {
+                    result.rows.add(row.get());
+                    row.release();
+                    result.names.add(name);
+                    result.quantities.add(quantity);
+                }
+                p = lineEnd + 1;
+            }
+        }
+        catch (...)
         {
-            bool shouldSwap = ascending
-                                  ? (matchedProducts.get(j) > matchedProducts.get(j + 1))
-                                  : (matchedProducts.get(j) < matchedProducts.get(j + 1));
+            result.failure = current_exception();
+        }
+    };
 
-            if (shouldSwap)
+    // Các luồng đọc content, bounds và results qua tham chiếu: luôn join trước khi rời khỏi hàm, kể cả khi
+    // tạo luồng ném ngoại lệ giữa chừng (khai báo sau results nên được huỷ trước)
+    struct WorkerJoin
+    {
+        unique_ptr<thread[]> threads;
+        int started = 0;
+        void joinAll()
+        {
+            for (; started > 0; started--)
             {
-                string temp = matchedProducts.get(j);
-                matchedProducts.set(j, matchedProducts.get(j + 1));
-                matchedProducts.set(j + 1, temp);
+                threads[started - 1].join();
             }
         }
+        ~WorkerJoin() { joinAll(); }
+    } workers;
+    workers.threads.reset(new thread[chunks]);
+    for (int c = 1; c < chunks; c++)
+    {
+        workers.threads[workers.started] = thread(parseChunk, c);
+        workers.started++;
     }
+    parseChunk(0);
+    workers.joinAll();
 
-    return matchedProducts;
-}
-inline void InventoryManager::removeDuplicates()
-{
-    int totalCount = size();
-    for (int current = 0; current < size() - 1; current++)
+    exception_ptr failure = nullptr;
+    int total = 0;
+    for (int c = 0; c < chunks; c++)
     {
-        for (int compare = current + 1; compare < size();)
+        total += results[c].rows.size();
+        if (results[c].failure != nullptr && failure == nullptr)
         {
-            // So sánh thuộc tính và tên sản phẩm
-            if (attributesMatrix
-                        .getRow(current)
-                        .toString() == attributesMatrix
-                                           .getRow(compare)
-                                           .toString() &&
-                productNames.get(current) == productNames.get(compare))
-            {
+            failure = results[c].failure;
+        }
+    }
+    if (failure != nullptr)
+    {
+        rethrow_exception(failure);
+    }
 
-                // Cộng số lượng sản phẩm
-                int combinedQuantity = quantities.get(current) + quantities.get(compare);
-                quantities.set(current, combinedQuantity);
+    // Chỉ mục phụ được dựng lại lười thay vì chèn từng hàng
+    clearAttributeIndexes();
+    clearNameIndex();
+    clearProductKeys();
 
-                // Loại bỏ sản phẩm trùng
-                removeProduct(compare);
-                totalCount--;
+    if (codec != nullptr)
+    {
+        // Chế độ lưu nén: mã hoá từng hàng rồi giải phóng bản giải nén
+        encodedRecords.reserve(encodedRecords.size() + total);
+        quantities.reserve(quantities.size() + total);
+        for (int c = 0; c < chunks; c++)
+        {
+            ChunkResult &result = results[c];
+            for (int r = 0; r < result.rows.size(); r++)
+            {
+                encodedRecords.add(codec->encodeRecord(*result.rows.get(r), result.names.get(r)));
+                quantities.add(result.quantities.get(r));
+                delete result.rows.get(r);
+                result.rows.get(r) = nullptr;
             }
-            else
+        }
+    }
+    else if (columns != nullptr)
+    {
+        writableColumns().reserve(columns->size() + total);
+        productNames.reserve(productNames.size() + total);
+        quantities.reserve(quantities.size() + total);
+        for (int c = 0; c < chunks; c++)
+        {
+            ChunkResult &result = results[c];
+            for (int r = 0; r < result.rows.size(); r++)
+            {
+                writableColumns().addRow(*result.rows.get(r), result.quantities.get(r));
+                productNames.add(result.names.get(r));
+                quantities.add(result.quantities.get(r));
+                delete result.rows.get(r);
+                result.rows.get(r) = nullptr;
+            }
+        }
+    }
+    else
+    {
+        // Nối một lần: cấp phát trước cho cả ba danh sách rồi chuyển quyền sở hữu các hàng đã dựng sẵn
+        attributesMatrix.reserve(attributesMatrix.rows() + total);
+        productNames.reserve(productNames.size() + total);
+        quantities.reserve(quantities.size() + total);
+        for (int c = 0; c < chunks; c++)
+        {
+            ChunkResult &result = results[c];
+            for (int r = 0; r < result.rows.size(); r++)
             {
-                compare++;
+                attributesMatrix.addRow(result.rows.get(r));
+                result.rows.get(r) = nullptr;
+                productNames.add(result.names.get(r));
+                quantities.add(result.quantities.get(r));
             }
         }
     }
+
+    // Chế độ gộp khi thêm: gộp các hàng vừa nạp một lần thay vì tra từng hàng
+    if (dedupeOnInsert)
+    {
+        removeDuplicates();
+    }
+    return total;
 }
-inline InventoryManager InventoryManager::merge(const InventoryManager &inv1, const InventoryManager &inv2)
+
+inline void InventoryManager::enableCompressedStorage(IRecordCodec *newCodec, int cacheCapacity)
 {
-    InventoryManager result = inv1;
-    for (int i = 0; i < inv2.size(); i++)
+    if (newCodec == nullptr)
     {
-        result.addProduct(inv2.getProductAttributes(i), inv2.getProductName(i), inv2.getProductQuantity(i));
+        throw invalid_argument("Codec must not be null");
     }
-    result.removeDuplicates(); // Loại bỏ các sản phẩm trùng lặp
-    return result;
+    if (cacheCapacity <= 0)
+    {
+        throw invalid_argument("Cache capacity must be positive");
+    }
+    if (codec != nullptr)
+    {
+        disableCompressedStorage();
+    }
+    disableColumnarStorage();
+
+    CowColumn<string> records;
+    records.reserve(size());
+    for (int i = 0; i < size(); i++)
+    {
+        records.add(newCodec->encodeRecord(attributesMatrix.getRow(i), productNames.get(i)));
+    }
+    encodedRecords = records;
+    attributesMatrix = CowRows<InventoryAttribute>();
+    productNames = CowColumn<string>();
+    codec = newCodec;
+    resetDecodeCache(cacheCapacity);
 }
 
-inline void InventoryManager::split(InventoryManager &section1, InventoryManager &section2, double ratio) const
+inline void InventoryManager::disableCompressedStorage()
 {
-    int total = size();
-    int size1 = (total * ratio + (total * ratio > 0)); // Làm tròn lên
-    int size2 = total - size1;
-    section1 = InventoryManager();
-    section2 = InventoryManager();
-    for (int i = 0; i < size1; i++)
+    if (codec == nullptr)
     {
-        section1.addProduct(getProductAttributes(i), getProductName(i), getProductQuantity(i));
+        return;
     }
-    for (int i = size1; i < total; i++)
+    CowRows<InventoryAttribute> matrix;
+    CowColumn<string> names;
+    matrix.reserve(size());
+    names.reserve(size());
+    for (int i = 0; i < size(); i++)
     {
-        section2.addProduct(getProductAttributes(i), getProductName(i), getProductQuantity(i));
+        const CachedProduct &product = decodeProduct(i);
+        matrix.addRow(new List1D<InventoryAttribute>(product.attributes));
+        names.add(product.name);
     }
+    attributesMatrix = matrix;
+    productNames = names;
+    encodedRecords = CowColumn<string>();
+    codec = nullptr;
+    resetDecodeCache(0);
 }
 
-inline List2D<InventoryAttribute> InventoryManager::getAttributesMatrix() const
+inline void InventoryManager::enableColumnarStorage()
 {
-    return attributesMatrix;
+    if (columns != nullptr)
+    {
+        return;
+    }
+    disableCompressedStorage();
+    shared_ptr<ColumnarStore> store = make_shared<ColumnarStore>();
+    store->reserve(size());
+    for (int i = 0; i < size(); i++)
+    {
+        store->addRow(attributesMatrix.getRow(i), quantities.get(i));
+    }
+    attributesMatrix = CowRows<InventoryAttribute>();
+    columns = store;
 }
 
-inline List1D<string> InventoryManager::getProductNames() const
+// Kho theo cột đang được một bản sao khác dùng chung thì tách bản riêng trước khi ghi: bản riêng chỉ chia
+// sẻ khối các cột (xem ColumnarStore), lần ghi chỉ sao chép những khối nó sửa
+inline ColumnarStore &InventoryManager::writableColumns()
 {
-    return productNames;
+    if (columns.use_count() != 1)
+        columns = make_shared<ColumnarStore>(*columns);
+    else
+        atomic_thread_fence(memory_order_acquire);
+    return *columns;
 }
 
-inline List1D<int> InventoryManager::getQuantities() const
+inline void InventoryManager::disableColumnarStorage()
 {
-    return quantities;
+    if (columns == nullptr)
+    {
+        return;
+    }
+    CowRows<InventoryAttribute> matrix;
+    matrix.reserve(size());
+    for (int i = 0; i < size(); i++)
+    {
+        matrix.addRow(new List1D<InventoryAttribute>(columns->getRow(i)));
+    }
+    attributesMatrix = matrix;
+    columns = nullptr;
 }
-inline string InventoryManager::toString() const
+
+inline long InventoryManager::compressedBytes() const
 {
-    stringstream ss;
-    ss << "InventoryManager[" << endl;
+    long total = 0;
+    for (int i = 0; i < encodedRecords.size(); i++)
+    {
+        total += (long)encodedRecords.get(i).length();
+    }
+    return total;
+}
 
-    // AttributesMatrix
-    ss << "  AttributesMatrix: [";
-    for (int i = 0; i < attributesMatrix.rows(); i++)
+// Tra bộ đệm theo ô index % sức chứa; trượt thì giải mã bản ghi và ghi đè ô đó
+inline const InventoryManager::CachedProduct &InventoryManager::decodeProduct(int index) const
+{
+    CachedProduct &slot = decodeCache.get(index % decodeCache.size());
+    if (slot.index != index)
     {
-        ss << "[";
-        List1D<InventoryAttribute> attributeRow = attributesMatrix.getRow(i);
-        bool firstAttr = true;
+        List1D<InventoryAttribute> attributes;
+        string name;
+        if (!codec->decodeRecord(encodedRecords.get(index), attributes, name))
+        {
+            throw runtime_error("Corrupted compressed product record");
+        }
+        slot.index = index;
+        slot.name = name;
+        slot.attributes = attributes;
+    }
+    return slot;
+}
 
-        for (int j = 0; j < attributeRow.size(); j++)
+inline void InventoryManager::resetDecodeCache(int capacity) const
+{
+    // Gán danh sách mới để giải phóng cả các ô cũ (clear chỉ đặt lại số phần tử)
+    decodeCache = XArrayList<CachedProduct>();
+    decodeCache.reserve(capacity);
+    for (int i = 0; i < capacity; i++)
+    {
+        decodeCache.add(CachedProduct());
+    }
+}
+
+inline void InventoryManager::setAttributeIndexing(bool enabled)
+{
+    attributeIndexing = enabled;
+    if (!enabled)
+    {
+        clearAttributeIndexes();
+    }
+}
+
+inline int InventoryManager::nameHash(string &key, int capacity)
+{
+    return (int)(MurmurHash64A(key.data(), (int)key.length(), 0) % (uint64_t)capacity);
+}
+
+// Trả về chỉ mục của attributeName, dựng bằng một lượt duyệt kho nếu chưa có.
+// Giá trị NaN không bao giờ thoả điều kiện khoảng nên không được đưa vào chỉ mục
+inline InventoryManager::AttributeIndex *InventoryManager::attributeIndex(const string &attributeName) const
+{
+    // Chỉ tra mã, không intern: truy vấn một tên lạ không được làm phình bảng tên dùng chung
+    uint32_t nameId;
+    if (!AttributeNamePool::instance().find(attributeName, nameId))
+    {
+        return nullptr;
+    }
+    if (attributeIndexes == nullptr)
+    {
+        attributeIndexes = new xMap<uint32_t, AttributeIndex *>(&nameIdHash, 0.75f, 0, &xMap<uint32_t, AttributeIndex *>::freeValue);
+    }
+    if (attributeIndexes->containsKey(nameId))
+    {
+        return attributeIndexes->get(nameId);
+    }
+
+    Heap<IndexEntry> sorted;
+    for (int i = 0; i < size(); i++)
+    {
+        List1D<InventoryAttribute> attributes = getProductAttributes(i);
+        for (int j = 0; j < attributes.size(); j++)
         {
-            if (!firstAttr)
-                ss << ", ";
-            InventoryAttribute attr = attributeRow.get(j);
-            ss << attr.name << ": ";
-            // Định dạng số với 6 chữ số thập phân
-            ss << fixed << setprecision(6) << attr.value;
-            firstAttr = false;
+            InventoryAttribute attribute = attributes.get(j);
+            if (attribute.name.id() == nameId && attribute.value == attribute.value)
+            {
+                sorted.push(IndexEntry{attribute.value, i});
+            }
         }
+    }
+    AttributeIndex *index = new AttributeIndex();
+    index->reserve(sorted.size());
+    while (!sorted.empty())
+    {
+        index->add(sorted.pop());
+    }
+    attributeIndexes->put(nameId, index);
+    return index;
+}
 
-        ss << "]";
-        if (i < attributesMatrix.rows() - 1)
-            ss << ", ";
+// Chèn các thuộc tính của sản phẩm mới vào những chỉ mục đã dựng
+inline void InventoryManager::indexProduct(int index, const List1D<InventoryAttribute> &attributes)
+{
+    if (attributeIndexes == nullptr)
+    {
+        return;
     }
-    ss << "]," << endl;
+    for (int j = 0; j < attributes.size(); j++)
+    {
+        InventoryAttribute attribute = attributes.get(j);
+        if (attribute.value != attribute.value || !attributeIndexes->containsKey(attribute.name.id()))
+        {
+            continue;
+        }
+        AttributeIndex &entries = *attributeIndexes->get(attribute.name.id());
+        IndexEntry entry{attribute.value, index};
+        int low = 0;
+        int high = entries.size();
+        while (low < high)
+        {
+            int mid = low + (high - low) / 2;
+            if (!(entry < entries.get(mid)))
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        entries.add(low, entry);
+    }
+}
 
-    // ProductNames
-    ss << "  ProductNames: [";
-    for (int i = 0; i < productNames.size(); i++)
+// Xoá các mục của sản phẩm index và dịch chỉ số các sản phẩm phía sau; thứ tự (giá trị, chỉ số)
+// không đổi vì mọi chỉ số lớn hơn cùng giảm 1
+inline void InventoryManager::unindexProduct(int index)
+{
+    if (attributeIndexes == nullptr)
     {
-        ss << productNames.get(i);
-        if (i < productNames.size() - 1)
-            ss << ", ";
+        return;
     }
-    ss << "]," << endl;
+    DLinkedList<AttributeIndex *> indexes = attributeIndexes->values();
+    for (AttributeIndex *entries : indexes)
+    {
+        int kept = 0;
+        for (int p = 0; p < entries->size(); p++)
+        {
+            IndexEntry entry = entries->get(p);
+            if (entry.product == index)
+                continue;
+            if (entry.product > index)
+                entry.product--;
+            entries->get(kept++) = entry;
+        }
+        while (entries->size() > kept)
+        {
+            entries->removeAt(entries->size() - 1);
+        }
+    }
+}
 
-    // Quantities
-    ss << "  Quantities: [";
-    for (int i = 0; i < quantities.size(); i++)
+inline void InventoryManager::clearAttributeIndexes() const
+{
+    delete attributeIndexes;
+    attributeIndexes = nullptr;
+}
+
+inline List1D<int> InventoryManager::findByName(const string &name) const
+{
+    XArrayList<int> *indices = productsNamed(name, false);
+    List1D<int> result;
+    if (indices == nullptr)
     {
-        ss << quantities.get(i);
-        if (i < quantities.size() - 1)
-            ss << ", ";
+        return result;
     }
-    ss << "]" << endl;
+    result.reserve(indices->size());
+    for (int i = 0; i < indices->size(); i++)
+    {
+        result.add(indices->get(i));
+    }
+    return result;
+}
 
-    ss << "]";
-    return ss.str();
+// Danh sách chỉ số của tên name (nullptr nếu không có và create == false), dựng cả chỉ mục bằng
+// một lượt duyệt nếu chưa có
+inline XArrayList<int> *InventoryManager::productsNamed(const string &name, bool create) const
+{
+    if (nameIndex == nullptr)
+    {
+        nameIndex = new xMap<string, XArrayList<int> *>(&nameHash, 0.75f, 0, &xMap<string, XArrayList<int> *>::freeValue);
+        for (int i = 0; i < size(); i++)
+        {
+            string productName = getProductName(i);
+            if (!nameIndex->containsKey(productName))
+            {
+                nameIndex->put(productName, new XArrayList<int>());
+            }
+            nameIndex->get(productName)->add(i);
+        }
+    }
+    if (!nameIndex->containsKey(name))
+    {
+        if (!create)
+            return nullptr;
+        nameIndex->put(name, new XArrayList<int>());
+    }
+    return nameIndex->get(name);
+}
+
+inline void InventoryManager::clearNameIndex() const
+{
+    delete nameIndex;
+    nameIndex = nullptr;
+}
+
+// Bỏ index khỏi danh sách tăng dần và giảm 1 các chỉ số lớn hơn
+inline void InventoryManager::removeFromIndexList(XArrayList<int> &indices, int index)
+{
+    int kept = 0;
+    for (int i = 0; i < indices.size(); i++)
+    {
+        int value = indices.get(i);
+        if (value == index)
+            continue;
+        indices.get(kept++) = value > index ? value - 1 : value;
+    }
+    while (indices.size() > kept)
+    {
+        indices.removeAt(indices.size() - 1);
+    }
+}
+
+inline void InventoryManager::compactProducts(XArrayList<bool> &removed, XArrayList<int> &newQuantities)
+{
+    CowColumn<int> kept;
+    kept.reserve(size());
+    for (int i = 0; i < size(); i++)
+    {
+        if (!removed.get(i))
+            kept.add(newQuantities.get(i));
+    }
+    if (codec != nullptr)
+    {
+        encodedRecords.compact(removed);
+        resetDecodeCache(decodeCache.size());
+    }
+    else if (columns != nullptr)
+    {
+        writableColumns().compact(removed, newQuantities);
+        productNames.compact(removed);
+    }
+    else
+    {
+        attributesMatrix.compact(removed);
+        productNames.compact(removed);
+    }
+    quantities = kept;
+    // Chỉ số đã dịch: các chỉ mục được dựng lại khi cần
+    clearAttributeIndexes();
+    clearNameIndex();
+    clearProductKeys();
+}
+
+// Khoá nội dung của một sản phẩm: tên (kèm độ dài để không nhập nhằng với phần thuộc tính), rồi mỗi
+// thuộc tính là 4 byte mã intern của tên và giá trị theo định dạng mặc định của ostream ("%g") kết thúc
+// bằng ';'. Hai sản phẩm có cùng khoá khi và chỉ khi trùng tên và List1D::toString, đúng tiêu chí của
+// removeDuplicates. Ghi thẳng vào chuỗi, không qua ostringstream
+inline string InventoryManager::productKey(const string &name, const List1D<InventoryAttribute> &attributes)
+{
+    string key = to_string(name.length());
+    key += ':';
+    key += name;
+    char number[32];
+    for (int i = 0; i < attributes.size(); i++)
+    {
+        InventoryAttribute attribute = attributes.get(i);
+        uint32_t nameId = attribute.name.id();
+        key.append((const char *)&nameId, sizeof(nameId));
+        snprintf(number, sizeof(number), "%g", attribute.value);
+        key += number;
+        key += ';';
+    }
+    return key;
+}
+
+inline int InventoryManager::ContentTable::findOrInsert(const string &key, int index)
+{
+    uint64_t fingerprint = MurmurHash64A(key.data(), (int)key.length(), 0);
+    if (!byFingerprint.containsKey(fingerprint))
+    {
+        byFingerprint.put(fingerprint, keys.size());
+        keys.add(key);
+        indices.add(index);
+        return -1;
+    }
+    int slot = byFingerprint.get(fingerprint);
+    if (keys.get(slot) == key)
+    {
+        return indices.get(slot);
+    }
+    // Hai khoá khác nhau cùng dấu vân tay
+    if (collisions == nullptr)
+    {
+        collisions = new xMap<string, int>(&nameHash);
+    }
+    if (collisions->containsKey(key))
+    {
+        return collisions->get(key);
+    }
+    collisions->put(key, index);
+    return -1;
+}
+
+inline void InventoryManager::clearProductKeys() const
+{
+    delete productKeys;
+    productKeys = nullptr;
+}
+
+inline void InventoryManager::setDedupeOnInsert(bool enabled)
+{
+    if (enabled && !dedupeOnInsert)
+    {
+        removeDuplicates();
+    }
+    dedupeOnInsert = enabled;
+    if (!enabled)
+    {
+        clearProductKeys();
+    }
 }
 
 #endif /* INVENTORY_MANAGER_H */
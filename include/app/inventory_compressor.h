@@ -8,10 +8,33 @@
 #include <iomanip>
 #include <stdexcept>
 #include <utility>
+#include <climits>
+#include <memory>
+#include <mutex>
 #include "inventory.h"
 #include "hash/xMap.h"
 #include "heap/Heap.h"
 #include "list/XArrayList.h"
+#include "util/MurmurHash2_64.h"
+#include <fstream>
+#include <cstring>
+#include <random>
+#include <cmath>
+
+// Chuyển đổi giữa chữ số mã Huffman ('0'-'9', 'a'-'f') và giá trị số tương ứng
+inline int huffmanDigitValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return 10 + (c - 'a');
+    return -1;
+}
+
+inline char huffmanDigitChar(int d)
+{
+    return (d < 10) ? ('0' + d) : ('a' + (d - 10));
+}
 
 template <int treeOrder>
 class HuffmanTree
@@ -36,40 +59,291 @@ public:
     void generateCodes(xMap<char, std::string> &table);
     std::string decode(const std::string &huffmanCode);
 
+    // Giải mã đúng một ký tự bắt đầu từ vị trí pos, pos được cập nhật sau ký tự đó
+    bool decodeSymbol(const std::string &huffmanCode, size_t &pos, char &symbol) const;
+    bool empty() const { return root == nullptr; }
+
+    // Lưu/khôi phục hình dạng cây (duyệt tiền thứ tự) kèm tần suất các lá để dùng lại mô hình đã huấn luyện.
+    // weighted = false đọc định dạng cũ chỉ có hình dạng (tần suất được suy từ độ sâu lá)
+    void serialize(std::string &out) const;
+    bool deserialize(const std::string &data, size_t &pos, size_t end, bool weighted = true);
+
+    // Bố cục mảng phẳng dùng khi giải mã: các nút trong được đánh số lại (gốc là trạng thái 0) theo
+    // chiều rộng hoặc theo tần suất giảm dần (đường nóng trước), các con của một nút nằm liền nhau ở
+    // transitions[state * treeOrder + digit]: >= 0 là trạng thái kế tiếp, FLAT_INVALID là nhánh
+    // không hợp lệ (thiếu con hoặc nút giả), còn lại là nút lá -(ký tự + 1)
+    enum LayoutOrder
+    {
+        BREADTH_FIRST,
+        HOT_FIRST
+    };
+    static constexpr int FLAT_INVALID = INT_MIN;
+    void setLayoutOrder(LayoutOrder order);
+    LayoutOrder getLayoutOrder() const { return layoutOrder; }
+    int flattenStates(XArrayList<int> &transitions) const; // sao chép bố cục, trả về số trạng thái
+
 private:
     HuffmanNode *root;
+    int *flatTransitions;
+    int flatStates;
+    LayoutOrder layoutOrder;
+    void rebuildLayout();
+    void serializeRecursive(HuffmanNode *node, std::string &out) const;
+    HuffmanNode *deserializeRecursive(const std::string &data, size_t &pos, size_t end, int depth, bool weighted);
     void generateCodesRecursive(HuffmanNode *node, std::string code, xMap<char, std::string> &table);
     void destroyTree(HuffmanNode *node);
 };
 
 template <int treeOrder>
-class InventoryCompressor
+class InventoryCompressor : public IRecordCodec
 {
 public:
     InventoryCompressor(InventoryManager *manager);
     ~InventoryCompressor();
 
     void buildHuffman();
+
+    // Kết quả huấn luyện trên mẫu: độ dài mã trung bình (chữ số/ký tự) của mô hình mẫu trên tập
+    // giữ lại so với mô hình tối ưu dựng trực tiếp từ tập đó, ước lượng phần tỉ lệ nén bị mất
+    struct SamplingReport
+    {
+        int sampledProducts;
+        long sampledBytes;
+        int heldOutProducts;
+        long heldOutBytes;
+        double digitsPerSymbol;
+        double optimalDigitsPerSymbol;
+        double estimatedLossPercent;
+    };
+    // Huấn luyện mô hình chính từ một mẫu ngẫu nhiên (Bernoulli) hoặc phân tầng (mỗi tầng một sản phẩm)
+    // gồm khoảng sampleRatio * size() sản phẩm. Mọi ký tự 1..255 có tần số tối thiểu minCount
+    SamplingReport buildHuffmanSampled(double sampleRatio, bool stratified = false, int minCount = 1, unsigned int seed = 0);
+    // Huấn luyện mô hình chính từ bảng đếm ký tự có sẵn (ví dụ đếm khi đọc tệp theo luồng),
+    // không cần InventoryManager chứa dữ liệu
+    void buildHuffmanFromCounts(const long counts[256]);
     void printHuffmanTable();
     std::string productToString(const List1D<InventoryAttribute> &attributes, const std::string &name);
+    // Như productToString nhưng không làm tròn: giá trị không đọc lại đúng từ 6 chữ số thập phân được ghi
+    // ở dạng ngắn nhất đọc lại chính xác (formatExactValue). Dùng cho các định dạng lưu trữ phải khôi phục đúng dữ liệu
+    std::string productToExactString(const List1D<InventoryAttribute> &attributes, const std::string &name) const;
     std::string encodeHuffman(const List1D<InventoryAttribute> &attributes, const std::string &name);
     std::string decodeHuffman(const std::string &huffmanCode, List1D<InventoryAttribute> &attributesOutput, std::string &nameOutput);
+
+    // Tầng LZ77 (tuỳ chọn) đặt trước bộ mã Huffman: khi bật, buildHuffman huấn luyện thêm
+    // ba mô hình (literal, độ dài, khoảng cách) và encode/decodeHuffman đi qua tầng này
+    void setLZ77Enabled(bool enabled);
+    bool isLZ77Enabled() const { return lzEnabled; }
+
+    // Chế độ nén khối cho lưu trữ lạnh: BWT + move-to-front + mã hoá loạt số 0, sau đó mã Huffman.
+    // Sản phẩm được tuần tự hoá và nén từng khối một nên ngoài lưu trữ kết quả, bộ nhớ tạm chỉ phụ thuộc
+    // kích thước khối (mảng hậu tố khoảng 5 int mỗi byte)
+    void setBlockSize(int blockSize);
+    int getBlockSize() const { return bwtBlockSize; }
+    std::string compressBlockSorted();
+    bool decompressBlockSorted(const std::string &archive, List2D<InventoryAttribute> &attributesOutput, List1D<std::string> &namesOutput);
+
+    // Lưu/nạp mô hình đã huấn luyện (hình dạng cây, treeOrder, mô hình LZ77 nếu có, mã băm phiên bản)
+    // để bỏ qua buildHuffman khi khởi động; có thể chia sẻ giữa các instance và tiến trình
+    std::string exportModel() const;
+    bool importModel(const std::string &model);
+    bool saveModel(const std::string &path) const;
+    bool loadModel(const std::string &path);
+    uint64_t getModelVersion() const;
+
+    // Nhân mã hoá xử lý đầu vào theo từng từ 8 byte với bảng mã phẳng. encodeHuffmanFast cho ra
+    // cùng chuỗi chữ số như encodeHuffman; encodeHuffmanPacked ghi mỗi chữ số bằng PACKED_DIGIT_BITS
+    // bit (đúng log2(treeOrder) khi treeOrder là lũy thừa của 2) qua thanh ghi tích luỹ 64 bit
+    static constexpr int PACKED_DIGIT_BITS = treeOrder <= 2 ? 1 : (treeOrder <= 4 ? 2 : (treeOrder <= 8 ? 3 : 4));
+    std::string encodeHuffmanFast(const List1D<InventoryAttribute> &attributes, const std::string &name);
+    // Thứ tự bố cục mảng phẳng của cây giải mã (mặc định theo chiều rộng), giữ nguyên qua các lần huấn luyện lại
+    void setTreeLayout(typename HuffmanTree<treeOrder>::LayoutOrder order);
+    // Mã hoá một sản phẩm đã được productToString (dùng cho các tầng tuần tự hoá/mã hoá tách rời).
+    // Không thay đổi trạng thái của bộ nén nên có thể gọi song song với productToString
+    std::string encodeProductString(const std::string &productStr) const;
+    std::string encodeHuffmanPacked(const List1D<InventoryAttribute> &attributes, const std::string &name, long &digitCount);
+    // Như encodeHuffmanPacked cho một sản phẩm đã được productToString
+    std::string encodeProductPacked(const std::string &productStr, long &digitCount) const;
+    std::string decodeHuffmanPacked(const std::string &packed, long digitCount, List1D<InventoryAttribute> &attributesOutput, std::string &nameOutput);
+    static std::string unpackDigits(const std::string &packed, long digitCount);
+
+    // IRecordCodec cho chế độ lưu nén của InventoryManager: [kiểu: 1 byte] rồi
+    // RECORD_PACKED: [số chữ số: varint][số thuộc tính: varint][vị trí chữ số của từng "(" : varint,
+    // lưu hiệu với vị trí trước][mã đóng gói bit], hoặc RECORD_RAW: chuỗi productToExactString
+    // (khi chưa có mô hình hoặc có ký tự không có mã, để không mất dữ liệu). Giá trị không bị làm tròn
+    std::string encodeRecord(const List1D<InventoryAttribute> &attributes, const std::string &name) override;
+    bool decodeRecord(const std::string &record, List1D<InventoryAttribute> &attributes, std::string &name) override;
+    // Truy vấn trên dạng nén: khoá là các chữ số mã của "(tên: ", so khớp tại vị trí đầu mỗi thuộc tính
+    // và chỉ giải mã trường số ngay sau khoá khớp
+    std::string encodeAttributeKey(const std::string &attributeName) override;
+    int matchAttribute(const std::string &record, const std::string &key, double minValue, double maxValue) override;
+
+    // Bố cục nhiều luồng xen kẽ: ký tự thứ i được mã vào luồng i % streamCount, đầu khối có bảng nhảy
+    // [số luồng: 1 byte][số ký tự: 4 byte][độ dài các luồng trừ luồng cuối: 4 byte mỗi luồng].
+    // Bộ giải mã tiến tất cả các luồng trong cùng một vòng lặp nên các chuỗi phụ thuộc độc lập nhau.
+    // Luôn dùng bảng mã của mô hình chính (không qua tầng LZ77)
+    void setStreamCount(int streamCount);
+    int getStreamCount() const { return interleaveStreams; }
+    std::string encodeHuffmanInterleaved(const List1D<InventoryAttribute> &attributes, const std::string &name);
+    std::string decodeHuffmanInterleaved(const std::string &block, List1D<InventoryAttribute> &attributesOutput, std::string &nameOutput);
     // Define these functions outside the constructor
 private:
     xMap<char, std::string> *huffmanTable;
     InventoryManager *invManager;
     HuffmanTree<treeOrder> *tree;
+
+    // Một token của bộ phân tích LZ77: length == 0 nghĩa là literal
+    struct LZToken
+    {
+        char literal;
+        int length;
+        int distance;
+
+        // XArrayList yêu cầu so sánh và in phần tử
+        bool operator==(const LZToken &other) const
+        {
+            return literal == other.literal && length == other.length && distance == other.distance;
+        }
+        friend ostream &operator<<(ostream &os, const LZToken &token)
+        {
+            if (token.length == 0)
+                return os << token.literal;
+            return os << "<" << token.distance << "," << token.length << ">";
+        }
+    };
+
+    static constexpr int LZ_MIN_MATCH = 3;
+    static constexpr int LZ_MAX_MATCH = 255 - 2 + LZ_MIN_MATCH; // ký hiệu độ dài 2..255
+    static constexpr int LZ_DICT_SIZE = 4096;                    // từ điển dùng chung giữa các sản phẩm
+    static constexpr int LZ_DICT_HASH_BITS = 12;
+    static constexpr int LZ_MAX_CHAIN = 32;
+    static constexpr char LZ_MATCH_MARKER = '\x01'; // literal báo hiệu một tham chiếu (hoặc escape)
+
+    bool lzEnabled;
+    std::string lzDictionary;
+    int *lzDictHead; // chuỗi băm của từ điển, dựng một lần trong buildHuffman
+    int *lzDictPrev;
+    // Bộ nhớ nháp cho chuỗi băm cục bộ của lzParse, dùng lại giữa các sản phẩm thay vì cấp phát mỗi lần.
+    // lzParse là hàm const có thể chạy đồng thời (các bản sao kho dùng chung codec): luồng không giành
+    // được lzScratchLock thì cấp phát bộ nhớ riêng
+    mutable std::mutex lzScratchLock;
+    mutable std::unique_ptr<int[]> lzScratchHead;
+    mutable std::unique_ptr<int[]> lzScratchPrev;
+    mutable int lzScratchHeadCapacity;
+    mutable int lzScratchPrevCapacity;
+    static int *scratchArray(std::unique_ptr<int[]> &array, int &capacity, int size);
+    HuffmanTree<treeOrder> *lzLiteralTree;
+    HuffmanTree<treeOrder> *lzLengthTree;
+    HuffmanTree<treeOrder> *lzDistanceTree;
+    xMap<char, std::string> *lzLiteralTable;
+    xMap<char, std::string> *lzLengthTable;
+    xMap<char, std::string> *lzDistanceTable;
+
+    static constexpr int BWT_DEFAULT_BLOCK_SIZE = 100000;
+    static constexpr char BWT_RUN_A = '\x01'; // hai ký hiệu mã hoá độ dài loạt số 0 (cơ số 2 song ánh)
+    static constexpr char BWT_RUN_B = '\x02';
+    int bwtBlockSize;
+
+    // Bảng mã phẳng cho nhân mã hoá nhanh, dựng lại mỗi khi mô hình chính thay đổi. Mã ngắn được đặt
+    // sẵn ở dạng đích: FAST_SLOT_DIGITS chữ số trong một ô cố định (sao chép cả ô rồi tiến theo độ dài),
+    // và (mã đóng gói << 8) | số bit khi số bit <= FAST_MAX_PACKED_BITS. Mã dài hơn đi đường từng chữ số
+    static constexpr int FAST_MAX_PACKED_BITS = 28; // hai mã cùng vừa một lần dồn (8 + 2 * 28 bit)
+    static constexpr int FAST_SLOT_DIGITS = 16;
+    static constexpr int FAST_BLOCK_BYTES = 4096; // số byte đầu vào giữa hai lần kiểm tra chỗ trống ở đầu ra
+    unsigned short fastCodeLength[256]; // số chữ số của mã, 0 = ký tự không có mã
+    int fastCodeOffset[256];            // vị trí mã trong fastCodePool
+    uint64_t fastPackedEntry[256];      // 0 = không có mã hoặc mã quá dài
+    char fastCodeSlot[256][FAST_SLOT_DIGITS];
+    int fastMaxCodeLength;
+    std::string fastCodePool;
+    void rebuildFastTables();
+    static void growOutput(std::string &out, size_t need, size_t used, size_t processed, size_t total);
+    bool encodeDigitsFast(const std::string &input, std::string &out) const;
+    bool encodePackedFast(const std::string &input, std::string &out, long &digitCount) const;
+
+    // Bộ giải mã máy trạng thái cho dạng đóng gói: trạng thái là nút trong của cây, mỗi bước tiêu thụ
+    // một byte (8 / PACKED_DIGIT_BITS chữ số). Chỉ dùng được khi PACKED_DIGIT_BITS chia hết 8.
+    // Bảng được dựng lại ngay khi mô hình chính hoặc bố cục cây thay đổi, không dựng lười, để các đường
+    // đọc (giải mã, matchAttribute) chỉ đọc bảng và an toàn khi nhiều bản chụp kho dùng chung một codec
+    struct FSMEntry
+    {
+        int nextState;
+        unsigned char count; // số ký tự phát ra trong bước này
+        bool invalid;
+        char symbols[8];
+    };
+    static constexpr bool FSM_SUPPORTED = 8 % PACKED_DIGIT_BITS == 0;
+    static constexpr int FSM_DIGITS_PER_BYTE = 8 / PACKED_DIGIT_BITS;
+    FSMEntry *fsmTable;  // fsmStates * 256 bước chuyển
+    int *fsmTransitions; // bảng chuyển theo từng chữ số, dùng cho byte cuối chưa đầy
+    int fsmStates;
+    void buildFSM();
+    void clearFSM();
+    bool decodePackedFSM(const std::string &packed, long digitCount, std::string &decodedText) const;
+
+    std::string serializeProduct(const List1D<InventoryAttribute> &attributes, const std::string &name,
+                                 XArrayList<long> *attributeStarts, bool exactValues = false) const;
+    static bool readVarint(const std::string &data, size_t &pos, unsigned long &value);
+    static int packedDigitAt(const unsigned char *data, size_t length, long index);
+
+    static constexpr char RECORD_PACKED = 'P';
+    static constexpr char RECORD_RAW = 'R';
+
+    static constexpr int INTERLEAVE_DEFAULT_STREAMS = 4;
+    static constexpr int INTERLEAVE_MAX_STREAMS = 255;
+    int interleaveStreams;
+    typename HuffmanTree<treeOrder>::LayoutOrder treeLayout;
+
+    static xMap<char, std::string> *createCodeTable();
+    static void normalizeCounts(long counts[256]);
+    static void collectFrequencies(const long counts[256], XArrayList<std::pair<char, int>> &freqs);
+    static void buildTreeFromCounts(const long counts[256], HuffmanTree<treeOrder> *&model, xMap<char, std::string> *table);
+    static void appendRawDigits(std::string &out, unsigned long value, int width);
+    static bool readRawDigits(const std::string &code, size_t &pos, int width, unsigned long &value);
+    static int rawDigitCount(unsigned long value);
+    static unsigned int lzHash(const char *p, int bits);
+    bool parseProductString(const std::string &decodedText, List1D<InventoryAttribute> &attributesOutput, std::string &nameOutput);
+
+    static constexpr char MODEL_MAGIC[5] = "HFMD";
+    static constexpr unsigned int MODEL_FORMAT_VERSION = 2; // 1: cây chỉ có hình dạng, không có tần suất lá
+    static void appendUInt32(std::string &out, unsigned int value);
+    static bool readUInt32(const std::string &data, size_t &pos, unsigned int &value);
+    static void appendTree(std::string &out, const HuffmanTree<treeOrder> *model);
+    static bool readTree(const std::string &data, size_t &pos, HuffmanTree<treeOrder> *&model, xMap<char, std::string> *table,
+                         bool weighted = true);
+
+    void buildLZModels();
+    void buildLZDictionaryIndex();
+    void clearLZModels();
+    void lzParse(const std::string &input, XArrayList<LZToken> &tokens) const;
+    bool lzMatchPays(const std::string &input, int pos, int length, int distance) const;
+    std::string lzEncode(const std::string &input) const;
+    bool lzDecode(const std::string &huffmanCode, std::string &output);
+
+    static void bwtForward(const std::string &block, std::string &lastColumn, int &primaryIndex);
+    static bool bwtInverse(const std::string &lastColumn, int primaryIndex, std::string &block);
+    // Chỉ số MTF j > 0 được ghi thành ký hiệu j + 2 (1, 2 dành cho loạt số 0) nên một khối dùng tối đa
+    // 254 ký tự khác nhau; khối được cắt sớm hơn bwtBlockSize khi bảng chữ cái sắp vượt giới hạn này
+    static constexpr int BWT_MAX_SYMBOLS = 254;
+    size_t nextBlockLength(const std::string &text, size_t offset) const;
+    static void appendSortedBlock(std::string &archive, const std::string &block);
+    static bool readSortedBlock(const std::string &archive, size_t &pos, std::string &block);
+    // Dòng sản phẩm trong văn bản của chế độ khối: '\n' ngăn cách các sản phẩm, nên trong tên (sản phẩm hoặc
+    // thuộc tính) ký tự '\\' được ghi thành hai ký tự '\\' '\\', còn '\n' thành hai ký tự '\\' 'n'
+    static std::string escapeRecordLine(const std::string &record);
+    static std::string unescapeRecordLine(const std::string &line);
 };
 
-#endif // INVENTORY_COMPRESSOR_H
 template <int treeOrder>
-HuffmanTree<treeOrder>::HuffmanNode::HuffmanNode(char s, int f) : symbol(s), freq(f)
+long HuffmanTree<treeOrder>::HuffmanNode::nextId = 0;
+
+template <int treeOrder>
+HuffmanTree<treeOrder>::HuffmanNode::HuffmanNode(char s, int f) : symbol(s), freq(f), id(nextId++)
 {
     // Constructor cho nút lá
 }
 
 template <int treeOrder>
-HuffmanTree<treeOrder>::HuffmanNode::HuffmanNode(int f, const XArrayList<HuffmanNode *> &childs) : symbol('\0'), freq(f)
+HuffmanTree<treeOrder>::HuffmanNode::HuffmanNode(int f, const XArrayList<HuffmanNode *> &childs) : symbol('\0'), freq(f), id(nextId++)
 {
     // Phương án 1: Sử dụng constructor sao chép để tạo bản sao tạm thời của childs
     XArrayList<HuffmanNode *> tempCopy = childs; // Gọi constructor sao chép
@@ -94,7 +368,7 @@ HuffmanTree<treeOrder>::HuffmanNode::HuffmanNode(int f, const XArrayList<Huffman
 
 ///////////////////////////// Triển khai HuffmanTree ////////////////////////
 template <int treeOrder>
-HuffmanTree<treeOrder>::HuffmanTree() : root(nullptr)
+HuffmanTree<treeOrder>::HuffmanTree() : root(nullptr), flatTransitions(nullptr), flatStates(0), layoutOrder(BREADTH_FIRST)
 {
     // Khởi tạo cây Huffman với nút gốc là nullptr
 }
@@ -107,6 +381,7 @@ HuffmanTree<treeOrder>::~HuffmanTree()
     {
         destroyTree(root);
     }
+    delete[] flatTransitions;
 }
 
 // Khai báo các phương thức để hiện thực đầy đủ lớp HuffmanTree
@@ -204,6 +479,7 @@ void HuffmanTree<treeOrder>::build(XArrayList<pair<char, int>> &symbolsFreqs)
 
     // Lấy nút gốc từ hàng đợi (hoặc NULL nếu hàng đợi trống)
     root = heap.empty() ? NULL : heap.pop();
+    rebuildLayout();
 }
 
 // Phương thức tạo mã Huffman cho từng ký tự
@@ -256,56 +532,40 @@ std::string HuffmanTree<treeOrder>::decode(const std::string &huffmanCode)
         return std::string(1, '\0'); // Mã không hợp lệ cho cây một nút
     }
 
-    std::string decodedText;     // Chuỗi kết quả giải mã
-    HuffmanNode *current = root; // Bắt đầu từ nút gốc
+    std::string decodedText; // Chuỗi kết quả giải mã
+    int state = 0;           // Bắt đầu từ nút gốc (trạng thái 0 của bố cục phẳng)
 
-    // Duyệt qua từng ký tự trong mã Huffman
+    // Duyệt qua từng ký tự trong mã Huffman, mỗi bước là một phép tính chỉ số trên mảng phẳng
     for (size_t i = 0; i < huffmanCode.length(); ++i)
     {
-        // Chuyển đổi ký tự mã sang chỉ số con
-        int childIndex;
-        char c = huffmanCode[i];
-
-        // Xử lý ký tự số (0-9)
-        if (c >= '0' && c <= '9')
-        {
-            childIndex = c - '0';
-        }
-        // Xử lý ký tự chữ (a-f)
-        else if (c >= 'a' && c <= 'f')
-        {
-            childIndex = 10 + (c - 'a');
-        }
-        else
+        // Chuyển đổi ký tự mã sang chỉ số con, ký tự ngoài '0'-'9', 'a'-'f' là không hợp lệ
+        int childIndex = huffmanDigitValue(huffmanCode[i]);
+        if (childIndex < 0 || childIndex >= treeOrder)
         {
-            // Ký tự không hợp lệ trong mã Huffman
             return std::string(1, '\0');
         }
 
-        // Kiểm tra chỉ số con có hợp lệ không
-        if (childIndex < 0 || childIndex >= current->children.size())
+        // Nhánh thiếu con hoặc dẫn tới ký tự giả → mã không hợp lệ
+        int next = flatTransitions[state * treeOrder + childIndex];
+        if (next == FLAT_INVALID)
         {
-            // Chỉ số con không hợp lệ
             return std::string(1, '\0');
         }
 
-        // Di chuyển tới nút con tương ứng với mã
-        current = current->children.get(childIndex);
-
-        // Nếu đến nút lá và không phải ký tự giả, thêm ký tự vào kết quả và quay về nút gốc
-        if (current->children.size() == 0)
+        // Đến nút lá: thêm ký tự vào kết quả và quay về nút gốc
+        if (next < 0)
         {
-            if (current->symbol == '\0')
-            {
-                return std::string(1, '\0'); // Gặp nút lá nhưng là ký tự giả → mã không hợp lệ
-            }
-            decodedText += current->symbol;
-            current = root;
+            decodedText += (char)(-next - 1);
+            state = 0;
+        }
+        else
+        {
+            state = next;
         }
     }
 
     // Kiểm tra xem đã giải mã hoàn toàn hay chưa
-    if (current != root)
+    if (state != 0)
     {
         // Mã không kết thúc tại nút lá, có thể không hợp lệ
         return std::string(1, '\0');
@@ -315,6 +575,54 @@ std::string HuffmanTree<treeOrder>::decode(const std::string &huffmanCode)
     return decodedText.empty() ? std::string(1, '\0') : decodedText;
 }
 
+// Giải mã đúng một ký tự từ mã Huffman bắt đầu tại vị trí pos
+// Dùng cho các luồng mã xen kẽ nhiều mô hình (ví dụ tầng LZ77)
+// Trả về false nếu mã không hợp lệ hoặc kết thúc giữa chừng
+template <int treeOrder>
+bool HuffmanTree<treeOrder>::decodeSymbol(const std::string &huffmanCode, size_t &pos, char &symbol) const
+{
+    if (root == nullptr || pos >= huffmanCode.length())
+    {
+        return false;
+    }
+
+    // Cây chỉ có một nút: mã luôn là chữ số lớn nhất của hệ cơ số treeOrder
+    if (root->children.size() == 0)
+    {
+        if (huffmanDigitValue(huffmanCode[pos]) != treeOrder - 1)
+        {
+            return false;
+        }
+        pos++;
+        symbol = root->symbol;
+        return true;
+    }
+
+    int state = 0;
+    while (pos < huffmanCode.length())
+    {
+        int childIndex = huffmanDigitValue(huffmanCode[pos++]);
+        if (childIndex < 0 || childIndex >= treeOrder)
+        {
+            return false;
+        }
+
+        // FLAT_INVALID: thiếu con hoặc nút giả không tương ứng với ký tự nào
+        int next = flatTransitions[state * treeOrder + childIndex];
+        if (next == FLAT_INVALID)
+        {
+            return false;
+        }
+        if (next < 0)
+        {
+            symbol = (char)(-next - 1);
+            return true;
+        }
+        state = next;
+    }
+    return false;
+}
+
 /*
 // Giải mã mã Huffman
 // Trả về chuỗi ký tự đã giải mã hoặc null character nếu không hợp lệ
@@ -400,6 +708,222 @@ std::string HuffmanTree<treeOrder>::decode(const std::string &huffmanCode)
     return decodedText.empty() ? std::string(1, '\0') : decodedText;
 }*/
 
+// Ghi hình dạng cây theo thứ tự trước: nút lá = [0][ký tự][tần suất: 4 byte little-endian],
+// nút trong = [số con][các con...]. Cây rỗng không ghi byte nào
+template <int treeOrder>
+void HuffmanTree<treeOrder>::serialize(std::string &out) const
+{
+    if (root != nullptr)
+    {
+        serializeRecursive(root, out);
+    }
+}
+
+template <int treeOrder>
+void HuffmanTree<treeOrder>::serializeRecursive(HuffmanNode *node, std::string &out) const
+{
+    if (node->children.empty())
+    {
+        out += '\0';
+        out += node->symbol;
+        for (int i = 0; i < 4; i++)
+        {
+            out += (char)(((unsigned int)node->freq >> (8 * i)) & 0xFF);
+        }
+        return;
+    }
+    out += (char)node->children.size();
+    for (int i = 0; i < node->children.size(); i++)
+    {
+        serializeRecursive(node->children.get(i), out);
+    }
+}
+
+// Dựng lại cây từ data[pos, end) do serialize tạo ra, thay thế cây hiện tại. Nút trong nhận tổng tần suất
+// các con như khi build, nên HOT_FIRST trên mô hình đã nạp cho cùng thứ tự với mô hình đã huấn luyện.
+// Định dạng cũ không có tần suất (weighted = false): mỗi lá nhận trọng số suy từ độ sâu
+// (2^30 / treeOrder^độ sâu, lá giả nhận 0); theo bất đẳng thức Kraft tổng không vượt quá 2^30
+template <int treeOrder>
+bool HuffmanTree<treeOrder>::deserialize(const std::string &data, size_t &pos, size_t end, bool weighted)
+{
+    if (root != nullptr)
+    {
+        destroyTree(root);
+        root = nullptr;
+    }
+    if (pos == end)
+    {
+        rebuildLayout();
+        return true; // cây rỗng
+    }
+    root = deserializeRecursive(data, pos, end, 0, weighted);
+    rebuildLayout();
+    return root != nullptr && pos == end;
+}
+
+template <int treeOrder>
+typename HuffmanTree<treeOrder>::HuffmanNode *HuffmanTree<treeOrder>::deserializeRecursive(const std::string &data, size_t &pos, size_t end, int depth, bool weighted)
+{
+    // Độ sâu tối đa bằng số ký tự có thể có, chặn dữ liệu hỏng gây tràn ngăn xếp
+    if (pos >= end || depth > 256)
+    {
+        return nullptr;
+    }
+    int childCount = (unsigned char)data[pos++];
+    if (childCount == 0)
+    {
+        if (pos >= end)
+        {
+            return nullptr;
+        }
+        char symbol = data[pos++];
+        int weight = 0;
+        if (weighted)
+        {
+            if (end - pos < 4)
+            {
+                return nullptr;
+            }
+            unsigned int freq = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                freq |= (unsigned int)(unsigned char)data[pos++] << (8 * i);
+            }
+            weight = (int)freq;
+        }
+        else if (symbol != '\0')
+        {
+            weight = 1 << 30;
+            for (int level = 0; level < depth && weight > 0; level++)
+            {
+                weight /= treeOrder;
+            }
+        }
+        return new HuffmanNode(symbol, weight);
+    }
+    if (childCount > treeOrder)
+    {
+        return nullptr;
+    }
+
+    XArrayList<HuffmanNode *> group;
+    for (int i = 0; i < childCount; i++)
+    {
+        HuffmanNode *child = deserializeRecursive(data, pos, end, depth + 1, weighted);
+        if (child == nullptr)
+        {
+            for (int j = 0; j < group.size(); j++)
+            {
+                destroyTree(group.get(j));
+            }
+            return nullptr;
+        }
+        group.add(child);
+    }
+    int weight = 0;
+    for (int i = 0; i < group.size(); i++)
+    {
+        weight += group.get(i)->freq;
+    }
+    return new HuffmanNode(weight, group);
+}
+
+template <int treeOrder>
+void HuffmanTree<treeOrder>::setLayoutOrder(LayoutOrder order)
+{
+    if (layoutOrder != order)
+    {
+        layoutOrder = order;
+        rebuildLayout();
+    }
+}
+
+// Dựng lại bố cục phẳng sau mỗi lần cây thay đổi (build, deserialize, đổi thứ tự).
+// BREADTH_FIRST: các tầng trên cùng nằm liền nhau ở đầu mảng.
+// HOT_FIRST: luôn đánh số tiếp nút trong có tần suất lớn nhất trong số các nút đã gặp
+// (bằng nhau thì nút gặp trước), nên các đường mã của ký tự phổ biến dồn về đầu mảng
+template <int treeOrder>
+void HuffmanTree<treeOrder>::rebuildLayout()
+{
+    delete[] flatTransitions;
+    flatTransitions = nullptr;
+    flatStates = 0;
+    if (root == nullptr || root->children.empty())
+    {
+        return;
+    }
+
+    // Thứ tự đánh số các nút trong; frontier là các nút trong đã gặp nhưng chưa được đánh số
+    XArrayList<HuffmanNode *> order;
+    XArrayList<HuffmanNode *> frontier;
+    frontier.add(root);
+    while (!frontier.empty())
+    {
+        int pick = 0;
+        if (layoutOrder == HOT_FIRST)
+        {
+            for (int k = 1; k < frontier.size(); k++)
+            {
+                if (frontier.get(k)->freq > frontier.get(pick)->freq)
+                {
+                    pick = k;
+                }
+            }
+        }
+        HuffmanNode *node = frontier.removeAt(pick);
+        order.add(node);
+        for (int digit = 0; digit < node->children.size(); digit++)
+        {
+            HuffmanNode *child = node->children.get(digit);
+            if (!child->children.empty())
+            {
+                frontier.add(child);
+            }
+        }
+    }
+
+    // Ghi bảng chuyển: chỉ số của nút con trong được tra qua vị trí của nó trong order
+    flatStates = order.size();
+    flatTransitions = new int[flatStates * treeOrder];
+    for (int state = 0; state < flatStates; state++)
+    {
+        HuffmanNode *node = order.get(state);
+        for (int digit = 0; digit < treeOrder; digit++)
+        {
+            int &slot = flatTransitions[state * treeOrder + digit];
+            if (digit >= node->children.size())
+            {
+                slot = FLAT_INVALID;
+                continue;
+            }
+            HuffmanNode *child = node->children.get(digit);
+            if (!child->children.empty())
+            {
+                slot = order.indexOf(child);
+            }
+            else if (child->symbol == '\0')
+            {
+                slot = FLAT_INVALID;
+            }
+            else
+            {
+                slot = -((int)(unsigned char)child->symbol + 1);
+            }
+        }
+    }
+}
+
+template <int treeOrder>
+int HuffmanTree<treeOrder>::flattenStates(XArrayList<int> &transitions) const
+{
+    transitions.clear();
+    for (int i = 0; i < flatStates * treeOrder; i++)
+    {
+        transitions.add(flatTransitions[i]);
+    }
+    return flatStates;
+}
+
 // Hàm đệ quy để tạo mã Huffman cho từng ký tự
 // Sử dụng std::string để lưu mã Huffman cho từng ký tự
 template <int treeOrder>
@@ -452,11 +976,40 @@ InventoryCompressor<treeOrder>::InventoryCompressor(InventoryManager *invManager
 {
     this->invManager = invManager;
     this->tree = nullptr; // Đảm bảo tree được khởi tạo là nullptr
+    this->huffmanTable = createCodeTable();
+
+    // Tầng LZ77 mặc định tắt, các mô hình chỉ được tạo khi buildHuffman
+    this->lzEnabled = false;
+    this->lzDictHead = nullptr;
+    this->lzDictPrev = nullptr;
+    this->lzScratchHeadCapacity = 0;
+    this->lzScratchPrevCapacity = 0;
+    this->lzLiteralTree = nullptr;
+    this->lzLengthTree = nullptr;
+    this->lzDistanceTree = nullptr;
+    this->lzLiteralTable = createCodeTable();
+    this->lzLengthTable = createCodeTable();
+    this->lzDistanceTable = createCodeTable();
+
+    this->bwtBlockSize = BWT_DEFAULT_BLOCK_SIZE;
+    this->interleaveStreams = INTERLEAVE_DEFAULT_STREAMS;
+    this->treeLayout = HuffmanTree<treeOrder>::BREADTH_FIRST;
+
+    this->fsmTable = nullptr;
+    this->fsmTransitions = nullptr;
+    this->fsmStates = 0;
+
+    rebuildFastTables();
+}
 
-    // Hash function cho xMap
+// Tạo một bảng mã rỗng (ký tự -> mã Huffman) dùng chung cho các mô hình
+template <int treeOrder>
+xMap<char, std::string> *InventoryCompressor<treeOrder>::createCodeTable()
+{
+    // Hash function cho xMap (ép về unsigned char để chỉ số không âm)
     auto hashFunc = [](char &key, int tableSize) -> int
     {
-        return (int)key % tableSize;
+        return (int)(unsigned char)key % tableSize;
     };
 
     // Hàm so sánh giá trị
@@ -484,7 +1037,7 @@ InventoryCompressor<treeOrder>::InventoryCompressor(InventoryManager *invManager
     };
 
     // Khởi tạo xMap với 6 tham số
-    huffmanTable = new xMap<char, std::string>(
+    return new xMap<char, std::string>(
         hashFunc,       // hash function
         0.75f,          // load factor
         compareValues,  // value equality function
@@ -507,6 +1060,12 @@ InventoryCompressor<treeOrder>::~InventoryCompressor()
     {
         delete tree;
     }
+
+    clearLZModels();
+    clearFSM();
+    delete lzLiteralTable;
+    delete lzLengthTable;
+    delete lzDistanceTable;
 }
 
 // Chuyển đổi thông tin sản phẩm thành chuỗi theo định dạng: "tên sản phẩm, thuộc tính1, thuộc tính2, ..."
@@ -611,7 +1170,155 @@ void InventoryCompressor<treeOrder>::buildHuffman()
     // Tạo bảng mã Huffman từ cây
     this->huffmanTable->clear(); // Xóa bảng cũ nếu có
     this->tree->generateCodes(*this->huffmanTable);
+    rebuildFastTables();
+
+    // Huấn luyện thêm các mô hình của tầng LZ77 nếu được bật
+    if (lzEnabled)
+    {
+        buildLZModels();
+    }
+}
+// Huấn luyện trên mẫu cho kho hàng rất lớn: phân bố ký tự hội tụ sau một mẫu nhỏ nên không cần
+// tuần tự hoá mọi sản phẩm. Một tập giữ lại (rời với mẫu) được dùng để ước lượng mức mất tỉ lệ nén
+// so với huấn luyện đầy đủ. Chỉ mô hình chính được huấn luyện trên mẫu; các mô hình LZ77 (nếu bật)
+// vẫn được huấn luyện như buildHuffman
+template <int treeOrder>
+typename InventoryCompressor<treeOrder>::SamplingReport
+InventoryCompressor<treeOrder>::buildHuffmanSampled(double sampleRatio, bool stratified, int minCount, unsigned int seed)
+{
+    if (sampleRatio <= 0.0 || sampleRatio > 1.0)
+    {
+        throw std::invalid_argument("Sample ratio must be in (0, 1]");
+    }
+    if (minCount < 1)
+    {
+        minCount = 1;
+    }
+
+    SamplingReport report = {0, 0, 0, 0, 0.0, 0.0, 0.0};
+    long sampleCounts[256] = {0};
+    long heldOutCounts[256] = {0};
+    int total = invManager->size();
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // Đếm ký tự của một sản phẩm vào mảng counts, trả về số byte
+    auto countProduct = [this](int index, long *counts) -> long
+    {
+        std::string productStr = productToString(invManager->getProductAttributes(index), invManager->getProductName(index));
+        for (size_t i = 0; i < productStr.length(); i++)
+        {
+            counts[(unsigned char)productStr[i]]++;
+        }
+        return (long)productStr.length();
+    };
+
+    if (!stratified)
+    {
+        // Mỗi sản phẩm vào mẫu với xác suất sampleRatio, vào tập giữ lại với cùng xác suất
+        for (int i = 0; i < total; i++)
+        {
+            double r = uniform(rng);
+            if (r < sampleRatio)
+            {
+                report.sampledBytes += countProduct(i, sampleCounts);
+                report.sampledProducts++;
+            }
+            else if (r < 2 * sampleRatio)
+            {
+                report.heldOutBytes += countProduct(i, heldOutCounts);
+                report.heldOutProducts++;
+            }
+        }
+    }
+    else
+    {
+        // Chia dãy sản phẩm thành các tầng liên tiếp, mỗi tầng chọn một sản phẩm cho mẫu
+        // và một sản phẩm khác cho tập giữ lại
+        int strata = (int)std::ceil(sampleRatio * total);
+        for (int st = 0; st < strata; st++)
+        {
+            int lo = (int)((long)st * total / strata);
+            int hi = (int)((long)(st + 1) * total / strata);
+            if (hi <= lo)
+            {
+                continue;
+            }
+            int pick = lo + (int)(rng() % (unsigned int)(hi - lo));
+            report.sampledBytes += countProduct(pick, sampleCounts);
+            report.sampledProducts++;
+            if (hi - lo >= 2)
+            {
+                int other = lo + (int)(rng() % (unsigned int)(hi - lo - 1));
+                if (other >= pick)
+                {
+                    other++;
+                }
+                report.heldOutBytes += countProduct(other, heldOutCounts);
+                report.heldOutProducts++;
+            }
+        }
+    }
+    if (report.sampledProducts == 0 && total > 0)
+    {
+        report.sampledBytes += countProduct((int)(rng() % (unsigned int)total), sampleCounts);
+        report.sampledProducts++;
+    }
+
+    // Sàn tần số đảm bảo mọi ký tự đều có mã, kể cả ký tự không xuất hiện trong mẫu
+    long trainCounts[256] = {0};
+    for (int c = 1; c < 256; c++)
+    {
+        trainCounts[c] = sampleCounts[c] > minCount ? sampleCounts[c] : minCount;
+    }
+    buildTreeFromCounts(trainCounts, tree, huffmanTable);
+    rebuildFastTables();
+
+    // Ước lượng trên tập giữ lại; nếu không có thì dùng chính mẫu (mất mát ước lượng bằng 0)
+    long *evalCounts = report.heldOutBytes > 0 ? heldOutCounts : sampleCounts;
+    HuffmanTree<treeOrder> *optimalTree = nullptr;
+    xMap<char, std::string> *optimalTable = createCodeTable();
+    buildTreeFromCounts(evalCounts, optimalTree, optimalTable);
+
+    double cost = 0.0, optimalCost = 0.0, symbols = 0.0;
+    for (int c = 1; c < 256; c++)
+    {
+        if (evalCounts[c] == 0)
+        {
+            continue;
+        }
+        cost += (double)evalCounts[c] * huffmanTable->get((char)c).length();
+        optimalCost += (double)evalCounts[c] * optimalTable->get((char)c).length();
+        symbols += (double)evalCounts[c];
+    }
+    delete optimalTree;
+    delete optimalTable;
+
+    if (symbols > 0)
+    {
+        report.digitsPerSymbol = cost / symbols;
+        report.optimalDigitsPerSymbol = optimalCost / symbols;
+        report.estimatedLossPercent = 100.0 * (cost - optimalCost) / optimalCost;
+    }
+
+    if (lzEnabled)
+    {
+        buildLZModels();
+    }
+    return report;
+}
+
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::buildHuffmanFromCounts(const long counts[256])
+{
+    buildTreeFromCounts(counts, tree, huffmanTable);
+    rebuildFastTables();
+    if (lzEnabled && invManager != nullptr)
+    {
+        buildLZModels();
+    }
 }
+
 // Sử dụng hàm này để in bảng mã Huffman cho từng ký tự (*)
 template <int treeOrder>
 void InventoryCompressor<treeOrder>::printHuffmanTable()
@@ -648,7 +1355,23 @@ void InventoryCompressor<treeOrder>::printHuffmanTable()
 template <int treeOrder>
 std::string InventoryCompressor<treeOrder>::productToString(const List1D<InventoryAttribute> &attributes, const std::string &name)
 {
-    // TODO: Chuyển đổi dữ liệu sản phẩm thành chuỗi theo định dạng: "tên sản phẩm:(thuộc tính1:giá trị1), (thuộc tính2:giá trị2), ..."
+    return serializeProduct(attributes, name, nullptr);
+}
+
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::productToExactString(const List1D<InventoryAttribute> &attributes,
+                                                                 const std::string &name) const
+{
+    return serializeProduct(attributes, name, nullptr, true);
+}
+
+// Như productToString; attributeStarts (nếu có) nhận vị trí ký tự "(" mở đầu từng thuộc tính
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::serializeProduct(const List1D<InventoryAttribute> &attributes,
+                                                             const std::string &name,
+                                                             XArrayList<long> *attributeStarts,
+                                                             bool exactValues) const
+{
     std::stringstream ss;
 
     // Thêm tên sản phẩm vào chuỗi kết quả
@@ -658,7 +1381,24 @@ std::string InventoryCompressor<treeOrder>::productToString(const List1D<Invento
     for (int i = 0; i < attributes.size(); i++)
     {
         InventoryAttribute attr = attributes.get(i);
-        ss << "(" << attr.name << ": " << std::fixed << std::setprecision(6) << attr.value << ")";
+        if (attributeStarts != nullptr)
+        {
+            attributeStarts->add((long)ss.tellp());
+        }
+        ss << "(" << attr.name << ": ";
+        if (exactValues && std::isfinite(attr.value))
+        {
+            // Giữ dạng 6 chữ số thập phân khi nó đọc lại đúng giá trị để bản ghi trùng với productToString
+            char fixedText[32];
+            bool fixedExact = std::fabs(attr.value) < 1e15 && snprintf(fixedText, sizeof(fixedText), "%.6f", attr.value) > 0 &&
+                              strtod(fixedText, nullptr) == attr.value;
+            ss << (fixedExact ? std::string(fixedText) : formatExactValue(attr.value));
+        }
+        else
+        {
+            ss << std::fixed << std::setprecision(6) << attr.value;
+        }
+        ss << ")";
 
         // Thêm dấu phẩy và khoảng trắng giữa các thuộc tính nếu không phải thuộc tính cuối cùng
         if (i < attributes.size() - 1)
@@ -683,6 +1423,12 @@ std::string InventoryCompressor<treeOrder>::encodeHuffman(const List1D<Inventory
         return std::string();
     }
 
+    // Tầng LZ77: thay các chuỗi con lặp lại bằng tham chiếu (khoảng cách, độ dài)
+    if (lzEnabled)
+    {
+        return lzEncode(productStr);
+    }
+
     // Chuỗi kết quả mã hóa
     std::string encodedString;
 
@@ -722,7 +1468,18 @@ std::string InventoryCompressor<treeOrder>::decodeHuffman(const std::string &huf
     }
 
     // Giải mã chuỗi Huffman
-    std::string decodedText = tree->decode(huffmanCode);
+    std::string decodedText;
+    if (lzEnabled)
+    {
+        if (!lzDecode(huffmanCode, decodedText))
+        {
+            return std::string();
+        }
+    }
+    else
+    {
+        decodedText = tree->decode(huffmanCode);
+    }
 
     // Nếu giải mã không thành công (trả về null character)
     if (decodedText.length() == 1 && decodedText[0] == '\0')
@@ -730,6 +1487,16 @@ std::string InventoryCompressor<treeOrder>::decodeHuffman(const std::string &huf
         return std::string();
     }
 
+    parseProductString(decodedText, attributesOutput, nameOutput);
+    return decodedText;
+}
+
+// Phân tích chuỗi sản phẩm đã giải mã "tên:(thuộc tính: giá trị), ..." thành tên và danh sách thuộc tính
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::parseProductString(const std::string &decodedText,
+                                                        List1D<InventoryAttribute> &attributesOutput,
+                                                        std::string &nameOutput)
+{
     // Phân tích chuỗi giải mã
     std::string productName;
     List1D<InventoryAttribute> attributes;
@@ -789,5 +1556,2140 @@ std::string InventoryCompressor<treeOrder>::decodeHuffman(const std::string &huf
     nameOutput = productName;
     attributesOutput = attributes;
 
-    return decodedText;
-}
\ No newline at end of file
+    return colonPos != std::string::npos;
+}
+
+///////////////////// Tầng LZ77 trước bộ mã Huffman ////////////////////////
+// Bật/tắt tầng LZ77. Nếu mô hình chính đã được xây dựng, các mô hình LZ77 được huấn luyện ngay
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::setLZ77Enabled(bool enabled)
+{
+    if (lzEnabled == enabled)
+    {
+        return;
+    }
+    lzEnabled = enabled;
+
+    if (!enabled)
+    {
+        clearLZModels();
+    }
+    else if (tree != nullptr && invManager != nullptr)
+    {
+        buildLZModels();
+    }
+}
+
+// Xây dựng cây Huffman và bảng mã từ mảng đếm tần số của 256 giá trị byte
+// Ký tự '\0' được dành cho nút giả nên không được đưa vào mô hình
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::buildTreeFromCounts(const long counts[256],
+                                                         HuffmanTree<treeOrder> *&model,
+                                                         xMap<char, std::string> *table)
+{
+    if (model != nullptr)
+    {
+        delete model;
+    }
+    model = new HuffmanTree<treeOrder>();
+    table->clear();
+
+    XArrayList<std::pair<char, int>> freqs;
+    collectFrequencies(counts, freqs);
+
+    if (freqs.size() > 0)
+    {
+        model->build(freqs);
+        model->generateCodes(*table);
+    }
+}
+
+// Chuyển mảng đếm thành danh sách (ký tự, tần số) đầu vào của HuffmanTree::build
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::collectFrequencies(const long counts[256], XArrayList<std::pair<char, int>> &freqs)
+{
+    long scaled[256];
+    for (int c = 0; c < 256; c++)
+    {
+        scaled[c] = counts[c];
+    }
+    normalizeCounts(scaled);
+
+    freqs.clear();
+    for (int c = 1; c < 256; c++)
+    {
+        if (scaled[c] > 0)
+        {
+            freqs.add(std::make_pair((char)c, (int)scaled[c]));
+        }
+    }
+}
+
+// Thu nhỏ tần số khi tổng vượt quá phạm vi int của HuffmanNode::freq (ký tự có mặt giữ tối thiểu 1)
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::normalizeCounts(long counts[256])
+{
+    long total = 0;
+    for (int c = 1; c < 256; c++)
+    {
+        total += counts[c];
+    }
+    long divisor = 1;
+    while (total / divisor > INT_MAX / 2)
+    {
+        divisor *= 2;
+    }
+    if (divisor == 1)
+    {
+        return;
+    }
+    for (int c = 1; c < 256; c++)
+    {
+        if (counts[c] > 0)
+        {
+            long f = counts[c] / divisor;
+            counts[c] = f > 0 ? f : 1;
+        }
+    }
+}
+
+// Số chữ số hệ cơ số treeOrder cần để biểu diễn value (value = 0 cần 0 chữ số)
+template <int treeOrder>
+int InventoryCompressor<treeOrder>::rawDigitCount(unsigned long value)
+{
+    int digits = 0;
+    while (value > 0)
+    {
+        value /= treeOrder;
+        digits++;
+    }
+    return digits;
+}
+
+// Ghi value dưới dạng width chữ số hệ cơ số treeOrder (chữ số có trọng số cao đứng trước)
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::appendRawDigits(std::string &out, unsigned long value, int width)
+{
+    size_t start = out.length();
+    out.append(width, '0');
+    for (int i = width - 1; i >= 0; i--)
+    {
+        out[start + i] = huffmanDigitChar((int)(value % treeOrder));
+        value /= treeOrder;
+    }
+}
+
+// Đọc width chữ số hệ cơ số treeOrder bắt đầu tại pos
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::readRawDigits(const std::string &code, size_t &pos, int width, unsigned long &value)
+{
+    value = 0;
+    if (pos + width > code.length())
+    {
+        return false;
+    }
+    for (int i = 0; i < width; i++)
+    {
+        int d = huffmanDigitValue(code[pos++]);
+        if (d < 0 || d >= treeOrder)
+        {
+            return false;
+        }
+        value = value * treeOrder + d;
+    }
+    return true;
+}
+
+// Hàm băm 3 byte đầu tại p, trả về chỉ số trong bảng 2^bits phần tử
+template <int treeOrder>
+unsigned int InventoryCompressor<treeOrder>::lzHash(const char *p, int bits)
+{
+    unsigned int v = ((unsigned int)(unsigned char)p[0] << 16) |
+                     ((unsigned int)(unsigned char)p[1] << 8) |
+                     (unsigned int)(unsigned char)p[2];
+    return (v * 2654435761u) >> (32 - bits);
+}
+
+// Giải phóng các mô hình và từ điển của tầng LZ77
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::clearLZModels()
+{
+    delete lzLiteralTree;
+    delete lzLengthTree;
+    delete lzDistanceTree;
+    lzLiteralTree = nullptr;
+    lzLengthTree = nullptr;
+    lzDistanceTree = nullptr;
+
+    delete[] lzDictHead;
+    delete[] lzDictPrev;
+    lzDictHead = nullptr;
+    lzDictPrev = nullptr;
+    lzDictionary.clear();
+
+    lzLiteralTable->clear();
+    lzLengthTable->clear();
+    lzDistanceTable->clear();
+}
+
+// Huấn luyện tầng LZ77 trên toàn bộ sản phẩm của InventoryManager:
+// 1. Dựng từ điển dùng chung từ các chuỗi sản phẩm đầu tiên để bắt được phần lặp giữa các sản phẩm
+// 2. Phân tích tham lam từng sản phẩm và đếm tần số literal, độ dài, khoảng cách
+// 3. Xây dựng ba cây Huffman riêng cho ba luồng ký hiệu
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::buildLZModels()
+{
+    clearLZModels();
+
+    XArrayList<std::string> products;
+    List1D<std::string> itemNames = invManager->getProductNames();
+    for (int i = 0; i < itemNames.size(); i++)
+    {
+        products.add(productToString(invManager->getProductAttributes(i), itemNames.get(i)));
+    }
+
+    // Từ điển dùng chung, mỗi sản phẩm cách nhau bởi '\n'
+    for (int i = 0; i < products.size() && (int)lzDictionary.length() < LZ_DICT_SIZE; i++)
+    {
+        lzDictionary += products.get(i);
+        lzDictionary += '\n';
+    }
+    if ((int)lzDictionary.length() > LZ_DICT_SIZE)
+    {
+        lzDictionary.resize(LZ_DICT_SIZE);
+    }
+
+    buildLZDictionaryIndex();
+
+    long literalCounts[256] = {0};
+    long lengthCounts[256] = {0};
+    long distanceCounts[256] = {0};
+    bool seen[256] = {false};
+
+    XArrayList<LZToken> tokens;
+    for (int i = 0; i < products.size(); i++)
+    {
+        std::string &product = products.get(i);
+        for (size_t j = 0; j < product.length(); j++)
+        {
+            seen[(unsigned char)product[j]] = true;
+        }
+
+        lzParse(product, tokens);
+        for (int t = 0; t < tokens.size(); t++)
+        {
+            LZToken &token = tokens.get(t);
+            if (token.length == 0)
+            {
+                literalCounts[(unsigned char)token.literal]++;
+                if (token.literal == LZ_MATCH_MARKER)
+                {
+                    lengthCounts[1]++; // escape cho ký tự trùng với marker
+                }
+            }
+            else
+            {
+                literalCounts[(unsigned char)LZ_MATCH_MARKER]++;
+                lengthCounts[token.length - LZ_MIN_MATCH + 2]++;
+                distanceCounts[rawDigitCount(token.distance - 1) + 1]++;
+            }
+        }
+    }
+
+    // Mọi ký tự xuất hiện trong dữ liệu huấn luyện đều phải có mã literal,
+    // vì khi mã hoá một tham chiếu có thể bị bỏ qua nếu không có lợi
+    for (int c = 1; c < 256; c++)
+    {
+        if (seen[c] && literalCounts[c] == 0)
+        {
+            literalCounts[c] = 1;
+        }
+    }
+
+    buildTreeFromCounts(literalCounts, lzLiteralTree, lzLiteralTable);
+    buildTreeFromCounts(lengthCounts, lzLengthTree, lzLengthTable);
+    buildTreeFromCounts(distanceCounts, lzDistanceTree, lzDistanceTable);
+}
+
+// Dựng chuỗi băm của từ điển dùng chung một lần, dùng lại cho mọi lần mã hoá
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::buildLZDictionaryIndex()
+{
+    delete[] lzDictHead;
+    delete[] lzDictPrev;
+
+    int dictSize = (int)lzDictionary.length();
+    lzDictHead = new int[1 << LZ_DICT_HASH_BITS];
+    lzDictPrev = new int[dictSize > 0 ? dictSize : 1];
+    for (int i = 0; i < (1 << LZ_DICT_HASH_BITS); i++)
+    {
+        lzDictHead[i] = -1;
+    }
+    for (int i = 0; i + LZ_MIN_MATCH <= dictSize; i++)
+    {
+        unsigned int h = lzHash(lzDictionary.data() + i, LZ_DICT_HASH_BITS);
+        lzDictPrev[i] = lzDictHead[h];
+        lzDictHead[h] = i;
+    }
+}
+
+// Mảng nháp ít nhất size phần tử, cấp phát lại (bỏ nội dung cũ) khi chưa đủ
+template <int treeOrder>
+int *InventoryCompressor<treeOrder>::scratchArray(std::unique_ptr<int[]> &array, int &capacity, int size)
+{
+    if (capacity < size)
+    {
+        capacity = size > 2 * capacity ? size : 2 * capacity;
+        array.reset(new int[capacity]);
+    }
+    return array.get();
+}
+
+// Phân tích input thành dãy literal và tham chiếu (khoảng cách, độ dài)
+// Tìm đoạn khớp bằng chuỗi băm (hash chain) trên chính input và trên từ điển dùng chung;
+// khoảng cách được tính trên bộ đệm ảo "từ điển + input"
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::lzParse(const std::string &input, XArrayList<LZToken> &tokens) const
+{
+    tokens.clear();
+    int n = (int)input.length();
+    const char *data = input.data();
+    const char *dict = lzDictionary.data();
+    int dictSize = (int)lzDictionary.length();
+
+    // Bảng băm cục bộ theo kích thước input để không phải khởi tạo bảng lớn cho mỗi sản phẩm
+    int localBits = 6;
+    while ((1 << localBits) < 2 * n && localBits < 16)
+    {
+        localBits++;
+    }
+    std::unique_lock<std::mutex> scratch(lzScratchLock, std::try_to_lock);
+    std::unique_ptr<int[]> ownHead;
+    std::unique_ptr<int[]> ownPrev;
+    int ownHeadCapacity = 0;
+    int ownPrevCapacity = 0;
+    int *head = scratch.owns_lock() ? scratchArray(lzScratchHead, lzScratchHeadCapacity, 1 << localBits)
+                                    : scratchArray(ownHead, ownHeadCapacity, 1 << localBits);
+    int *prev = scratch.owns_lock() ? scratchArray(lzScratchPrev, lzScratchPrevCapacity, n > 0 ? n : 1)
+                                    : scratchArray(ownPrev, ownPrevCapacity, n > 0 ? n : 1);
+    for (int i = 0; i < (1 << localBits); i++)
+    {
+        head[i] = -1;
+    }
+
+    int pos = 0;
+    while (pos < n)
+    {
+        int bestLength = 0;
+        int bestDistance = 0;
+
+        if (pos + LZ_MIN_MATCH <= n)
+        {
+            int maxLength = (n - pos < LZ_MAX_MATCH) ? n - pos : LZ_MAX_MATCH;
+
+            // Ứng viên trong chính input (gần nhất trước)
+            int candidate = head[lzHash(data + pos, localBits)];
+            for (int chain = 0; candidate >= 0 && chain < LZ_MAX_CHAIN; chain++)
+            {
+                int length = 0;
+                while (length < maxLength && data[candidate + length] == data[pos + length])
+                {
+                    length++;
+                }
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestDistance = pos - candidate;
+                }
+                candidate = prev[candidate];
+            }
+
+            // Ứng viên trong từ điển dùng chung
+            if (lzDictHead != nullptr && bestLength < maxLength)
+            {
+                candidate = lzDictHead[lzHash(data + pos, LZ_DICT_HASH_BITS)];
+                for (int chain = 0; candidate >= 0 && chain < LZ_MAX_CHAIN; chain++)
+                {
+                    int limit = (dictSize - candidate < maxLength) ? dictSize - candidate : maxLength;
+                    int length = 0;
+                    while (length < limit && dict[candidate + length] == data[pos + length])
+                    {
+                        length++;
+                    }
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = pos + dictSize - candidate;
+                    }
+                    candidate = lzDictPrev[candidate];
+                }
+            }
+        }
+
+        int advance = 1;
+        if (bestLength >= LZ_MIN_MATCH && lzMatchPays(input, pos, bestLength, bestDistance))
+        {
+            tokens.add(LZToken{'\0', bestLength, bestDistance});
+            advance = bestLength;
+        }
+        else
+        {
+            tokens.add(LZToken{data[pos], 0, 0});
+        }
+
+        // Đưa các vị trí vừa đi qua vào chuỗi băm cục bộ
+        for (int i = pos; i < pos + advance; i++)
+        {
+            if (i + LZ_MIN_MATCH <= n)
+            {
+                unsigned int h = lzHash(data + i, localBits);
+                prev[i] = head[h];
+                head[h] = i;
+            }
+        }
+        pos += advance;
+    }
+}
+
+// Kiểm tra một tham chiếu có ngắn hơn việc mã hoá các literal tương ứng hay không
+// Khi đang huấn luyện (chưa có mô hình) mọi đoạn khớp đều được chấp nhận
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::lzMatchPays(const std::string &input, int pos, int length, int distance) const
+{
+    if (lzLengthTree == nullptr)
+    {
+        return true;
+    }
+
+    char lengthSymbol = (char)(length - LZ_MIN_MATCH + 2);
+    char distanceSymbol = (char)(rawDigitCount(distance - 1) + 1);
+    if (!lzLiteralTable->containsKey(LZ_MATCH_MARKER) ||
+        !lzLengthTable->containsKey(lengthSymbol) ||
+        !lzDistanceTable->containsKey(distanceSymbol))
+    {
+        return false;
+    }
+
+    size_t matchCost = lzLiteralTable->get(LZ_MATCH_MARKER).length() +
+                       lzLengthTable->get(lengthSymbol).length() +
+                       lzDistanceTable->get(distanceSymbol).length() +
+                       rawDigitCount(distance - 1);
+    size_t literalCost = 0;
+    for (int i = 0; i < length && literalCost <= matchCost; i++)
+    {
+        char c = input[pos + i];
+        if (!lzLiteralTable->containsKey(c))
+        {
+            return true; // ký tự không mã hoá được dưới dạng literal
+        }
+        literalCost += lzLiteralTable->get(c).length();
+    }
+    return matchCost < literalCost;
+}
+
+// Mã hoá chuỗi sản phẩm qua tầng LZ77: literal dùng mô hình literal, tham chiếu được ghi là
+// marker + ký hiệu độ dài + ký hiệu số chữ số của khoảng cách + các chữ số thô của khoảng cách
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::lzEncode(const std::string &input) const
+{
+    XArrayList<LZToken> tokens;
+    lzParse(input, tokens);
+
+    std::string encodedString;
+    for (int t = 0; t < tokens.size(); t++)
+    {
+        LZToken &token = tokens.get(t);
+        if (token.length == 0)
+        {
+            char c = token.literal;
+            if (!lzLiteralTable->containsKey(c) ||
+                (c == LZ_MATCH_MARKER && !lzLengthTable->containsKey((char)1)))
+            {
+                std::cerr << "Warning: Character '" << c << "' not found in Huffman table" << std::endl;
+                continue;
+            }
+            encodedString += lzLiteralTable->get(c);
+            if (c == LZ_MATCH_MARKER)
+            {
+                encodedString += lzLengthTable->get((char)1);
+            }
+        }
+        else
+        {
+            int distanceDigits = rawDigitCount(token.distance - 1);
+            encodedString += lzLiteralTable->get(LZ_MATCH_MARKER);
+            encodedString += lzLengthTable->get((char)(token.length - LZ_MIN_MATCH + 2));
+            encodedString += lzDistanceTable->get((char)(distanceDigits + 1));
+            appendRawDigits(encodedString, token.distance - 1, distanceDigits);
+        }
+    }
+    return encodedString;
+}
+
+// Giải mã luồng LZ77 + Huffman. Khoảng cách tính trên bộ đệm ảo "từ điển + output" như lúc mã hoá:
+// vị trí nguồn nhỏ hơn kích thước từ điển được đọc thẳng từ lzDictionary, không sao chép từ điển
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::lzDecode(const std::string &huffmanCode, std::string &output)
+{
+    if (lzLiteralTree == nullptr || huffmanCode.empty())
+    {
+        return false;
+    }
+
+    const char *dict = lzDictionary.data();
+    size_t dictSize = lzDictionary.length();
+    output.clear();
+    size_t pos = 0;
+    while (pos < huffmanCode.length())
+    {
+        char symbol;
+        if (!lzLiteralTree->decodeSymbol(huffmanCode, pos, symbol))
+        {
+            return false;
+        }
+        if (symbol != LZ_MATCH_MARKER)
+        {
+            output += symbol;
+            continue;
+        }
+
+        char lengthSymbol;
+        if (!lzLengthTree->decodeSymbol(huffmanCode, pos, lengthSymbol))
+        {
+            return false;
+        }
+        int lengthValue = (unsigned char)lengthSymbol;
+        if (lengthValue == 1)
+        {
+            output += LZ_MATCH_MARKER; // escape
+            continue;
+        }
+
+        char distanceSymbol;
+        unsigned long distanceValue;
+        if (!lzDistanceTree->decodeSymbol(huffmanCode, pos, distanceSymbol) ||
+            !readRawDigits(huffmanCode, pos, (unsigned char)distanceSymbol - 1, distanceValue))
+        {
+            return false;
+        }
+
+        size_t distance = distanceValue + 1;
+        if (distance > dictSize + output.length())
+        {
+            return false;
+        }
+        // Sao chép từng byte để hỗ trợ đoạn khớp chồng lấn (kể cả đoạn bắt đầu trong từ điển)
+        size_t from = dictSize + output.length() - distance;
+        int length = lengthValue - 2 + LZ_MIN_MATCH;
+        for (int i = 0; i < length; i++, from++)
+        {
+            output += from < dictSize ? dict[from] : output[from - dictSize];
+        }
+    }
+
+    return !output.empty();
+}
+
+///////////////////// Chế độ nén khối: BWT + MTF + loạt số 0 ////////////////////////
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::setBlockSize(int blockSize)
+{
+    if (blockSize <= 0)
+    {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    bwtBlockSize = blockSize;
+}
+
+// Biến đổi Burrows-Wheeler: sắp xếp các phép quay vòng của khối bằng mảng hậu tố vòng
+// (nhân đôi tiền tố + counting sort, O(n log n)) rồi lấy cột cuối cùng
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::bwtForward(const std::string &block, std::string &lastColumn, int &primaryIndex)
+{
+    int n = (int)block.length();
+    lastColumn.assign(n, '\0');
+    primaryIndex = 0;
+    if (n == 0)
+    {
+        return;
+    }
+
+    int *p = new int[n];
+    int *c = new int[n];
+    int *pn = new int[n];
+    int *cn = new int[n];
+    int *cnt = new int[n > 256 ? n : 256];
+
+    // Bước đầu: sắp xếp theo ký tự đầu tiên
+    for (int i = 0; i < 256; i++)
+        cnt[i] = 0;
+    for (int i = 0; i < n; i++)
+        cnt[(unsigned char)block[i]]++;
+    for (int i = 1; i < 256; i++)
+        cnt[i] += cnt[i - 1];
+    for (int i = n - 1; i >= 0; i--)
+        p[--cnt[(unsigned char)block[i]]] = i;
+
+    int classes = 1;
+    c[p[0]] = 0;
+    for (int i = 1; i < n; i++)
+    {
+        if (block[p[i]] != block[p[i - 1]])
+            classes++;
+        c[p[i]] = classes - 1;
+    }
+
+    // Mỗi vòng nhân đôi độ dài tiền tố đã được sắp xếp
+    for (int len = 1; len < n && classes < n; len <<= 1)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            pn[i] = p[i] - len;
+            if (pn[i] < 0)
+                pn[i] += n;
+        }
+        for (int i = 0; i < classes; i++)
+            cnt[i] = 0;
+        for (int i = 0; i < n; i++)
+            cnt[c[pn[i]]]++;
+        for (int i = 1; i < classes; i++)
+            cnt[i] += cnt[i - 1];
+        for (int i = n - 1; i >= 0; i--)
+            p[--cnt[c[pn[i]]]] = pn[i];
+
+        cn[p[0]] = 0;
+        classes = 1;
+        for (int i = 1; i < n; i++)
+        {
+            int cur = p[i] + len;
+            int prv = p[i - 1] + len;
+            if (cur >= n)
+                cur -= n;
+            if (prv >= n)
+                prv -= n;
+            if (c[p[i]] != c[p[i - 1]] || c[cur] != c[prv])
+                classes++;
+            cn[p[i]] = classes - 1;
+        }
+        int *tmp = c;
+        c = cn;
+        cn = tmp;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        lastColumn[i] = block[p[i] == 0 ? n - 1 : p[i] - 1];
+        if (p[i] == 0)
+            primaryIndex = i;
+    }
+
+    delete[] p;
+    delete[] c;
+    delete[] pn;
+    delete[] cn;
+    delete[] cnt;
+}
+
+// Biến đổi ngược BWT bằng ánh xạ LF: đi lùi từ hàng chứa khối gốc
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::bwtInverse(const std::string &lastColumn, int primaryIndex, std::string &block)
+{
+    int n = (int)lastColumn.length();
+    block.assign(n, '\0');
+    if (n == 0)
+    {
+        return true;
+    }
+    if (primaryIndex < 0 || primaryIndex >= n)
+    {
+        return false;
+    }
+
+    int start[256] = {0};
+    for (int i = 0; i < n; i++)
+        start[(unsigned char)lastColumn[i]]++;
+    for (int ch = 0, sum = 0; ch < 256; ch++)
+    {
+        int count = start[ch];
+        start[ch] = sum;
+        sum += count;
+    }
+
+    int *lf = new int[n];
+    for (int i = 0; i < n; i++)
+        lf[i] = start[(unsigned char)lastColumn[i]]++;
+
+    int row = primaryIndex;
+    for (int k = n - 1; k >= 0; k--)
+    {
+        block[k] = lastColumn[row];
+        row = lf[row];
+    }
+
+    delete[] lf;
+    return true;
+}
+
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::escapeRecordLine(const std::string &record)
+{
+    std::string line;
+    line.reserve(record.length());
+    for (size_t i = 0; i < record.length(); i++)
+    {
+        if (record[i] == '\\')
+            line += "\\\\";
+        else if (record[i] == '\n')
+            line += "\\n";
+        else
+            line += record[i];
+    }
+    return line;
+}
+
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::unescapeRecordLine(const std::string &line)
+{
+    std::string record;
+    record.reserve(line.length());
+    for (size_t i = 0; i < line.length(); i++)
+    {
+        if (line[i] == '\\' && i + 1 < line.length() && (line[i + 1] == '\\' || line[i + 1] == 'n'))
+        {
+            record += line[i + 1] == 'n' ? '\n' : '\\';
+            i++;
+        }
+        else
+        {
+            record += line[i];
+        }
+    }
+    return record;
+}
+
+// Độ dài khối tiếp theo bắt đầu tại offset: tối đa bwtBlockSize ký tự và BWT_MAX_SYMBOLS ký tự khác nhau
+template <int treeOrder>
+size_t InventoryCompressor<treeOrder>::nextBlockLength(const std::string &text, size_t offset) const
+{
+    bool used[256] = {false};
+    int distinct = 0;
+    size_t end = offset;
+    while (end < text.length() && end - offset < (size_t)bwtBlockSize)
+    {
+        unsigned char ch = (unsigned char)text[end];
+        if (!used[ch])
+        {
+            if (distinct == BWT_MAX_SYMBOLS)
+            {
+                break;
+            }
+            used[ch] = true;
+            distinct++;
+        }
+        end++;
+    }
+    return end - offset;
+}
+
+// Nén toàn bộ sản phẩm của InventoryManager ở chế độ khối. Mỗi sản phẩm là một dòng (xem escapeRecordLine);
+// văn bản được nén ngay khi đủ một khối nên không bao giờ giữ toàn bộ văn bản hay mọi khối đã mã hoá.
+// Định dạng (chuỗi chữ số hệ treeOrder, W = số chữ số của một số 32 bit, D = của một byte):
+//   [số khối: W] rồi mỗi khối:
+//   [độ dài: W][hàng gốc: W][số ký tự dùng: D]{[ký tự: D]}[số mục tần số: W]{[ký hiệu: D][tần số: W]}
+//   [số ký hiệu: W][mã Huffman...]
+// Mỗi khối mang bảng tần số riêng để bộ giải nén dựng lại đúng cây Huffman của khối đó
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::compressBlockSorted()
+{
+    const int W = rawDigitCount(0xFFFFFFFFul);
+    std::string archive;
+    appendRawDigits(archive, 0, W); // số khối, ghi lại khi kết thúc
+
+    unsigned long blocks = 0;
+    std::string pending;
+    int n = invManager->size();
+    for (int i = 0; i <= n; i++)
+    {
+        if (i < n)
+        {
+            pending += escapeRecordLine(productToString(invManager->getProductAttributes(i), invManager->getProductName(i)));
+            pending += '\n';
+        }
+        // Nén các khối đã đầy; sau sản phẩm cuối cùng nén nốt phần còn lại
+        size_t offset = 0;
+        while (pending.length() - offset >= (size_t)bwtBlockSize || (i == n && offset < pending.length()))
+        {
+            size_t length = nextBlockLength(pending, offset);
+            appendSortedBlock(archive, pending.substr(offset, length));
+            offset += length;
+            blocks++;
+        }
+        pending.erase(0, offset);
+    }
+
+    std::string count;
+    appendRawDigits(count, blocks, W);
+    archive.replace(0, W, count);
+    return archive;
+}
+
+// BWT, move-to-front, mã hoá loạt số 0 rồi mã Huffman với mô hình riêng của khối
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::appendSortedBlock(std::string &archive, const std::string &block)
+{
+    std::string lastColumn;
+    int primaryIndex;
+    bwtForward(block, lastColumn, primaryIndex);
+
+    // Bảng MTF chỉ gồm các ký tự có mặt trong khối (nextBlockLength giữ số ký tự <= BWT_MAX_SYMBOLS)
+    bool used[256] = {false};
+    for (size_t i = 0; i < block.length(); i++)
+        used[(unsigned char)block[i]] = true;
+    std::string usedSymbols;
+    for (int ch = 0; ch < 256; ch++)
+        if (used[ch])
+            usedSymbols += (char)ch;
+    if (usedSymbols.length() > (size_t)BWT_MAX_SYMBOLS)
+    {
+        throw std::invalid_argument("Block uses too many distinct symbols");
+    }
+
+    // Move-to-front + mã hoá loạt số 0 bằng RUN_A/RUN_B, chỉ số j > 0 thành ký hiệu j + 2
+    std::string order = usedSymbols;
+    std::string coded;
+    long run = 0;
+    auto flushRun = [&coded](long &run)
+    {
+        while (run > 0)
+        {
+            if (run & 1)
+            {
+                coded += BWT_RUN_A;
+                run = (run - 1) / 2;
+            }
+            else
+            {
+                coded += BWT_RUN_B;
+                run = (run - 2) / 2;
+            }
+        }
+    };
+    for (size_t i = 0; i < lastColumn.length(); i++)
+    {
+        char ch = lastColumn[i];
+        int j = 0;
+        while (order[j] != ch)
+            j++;
+        if (j == 0)
+        {
+            run++;
+            continue;
+        }
+        flushRun(run);
+        order.erase(j, 1);
+        order.insert(order.begin(), ch);
+        coded += (char)(j + 2);
+    }
+    flushRun(run);
+
+    // Mô hình Huffman của khối cho phân bố ký hiệu sau MTF
+    long counts[256] = {0};
+    for (size_t i = 0; i < coded.length(); i++)
+        counts[(unsigned char)coded[i]]++;
+    XArrayList<std::pair<char, int>> freqs;
+    collectFrequencies(counts, freqs);
+    HuffmanTree<treeOrder> model;
+    xMap<char, std::string> *table = createCodeTable();
+    if (freqs.size() > 0)
+    {
+        model.build(freqs);
+        model.generateCodes(*table);
+    }
+    std::string codes[256];
+    for (int i = 0; i < freqs.size(); i++)
+    {
+        codes[(unsigned char)freqs.get(i).first] = table->get(freqs.get(i).first);
+    }
+    delete table;
+
+    const int W = rawDigitCount(0xFFFFFFFFul);
+    const int D = rawDigitCount(255);
+    appendRawDigits(archive, block.length(), W);
+    appendRawDigits(archive, primaryIndex, W);
+    appendRawDigits(archive, usedSymbols.length(), D);
+    for (size_t i = 0; i < usedSymbols.length(); i++)
+        appendRawDigits(archive, (unsigned char)usedSymbols[i], D);
+    appendRawDigits(archive, freqs.size(), W);
+    for (int i = 0; i < freqs.size(); i++)
+    {
+        appendRawDigits(archive, (unsigned char)freqs.get(i).first, D);
+        appendRawDigits(archive, freqs.get(i).second, W);
+    }
+    appendRawDigits(archive, coded.length(), W);
+    for (size_t i = 0; i < coded.length(); i++)
+        archive += codes[(unsigned char)coded[i]];
+}
+
+// Đọc một khối do appendSortedBlock ghi; trả về false nếu khối không hợp lệ
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::readSortedBlock(const std::string &archive, size_t &pos, std::string &block)
+{
+    const int W = rawDigitCount(0xFFFFFFFFul);
+    const int D = rawDigitCount(255);
+    unsigned long length, primaryIndex, usedCount, entries, codedCount, value;
+    if (!readRawDigits(archive, pos, W, length) || !readRawDigits(archive, pos, W, primaryIndex) ||
+        !readRawDigits(archive, pos, D, usedCount) || usedCount > (unsigned long)BWT_MAX_SYMBOLS)
+    {
+        return false;
+    }
+    std::string order;
+    for (unsigned long i = 0; i < usedCount; i++)
+    {
+        if (!readRawDigits(archive, pos, D, value))
+            return false;
+        order += (char)value;
+    }
+
+    if (!readRawDigits(archive, pos, W, entries) || entries > 255)
+    {
+        return false;
+    }
+    XArrayList<std::pair<char, int>> freqs;
+    for (unsigned long i = 0; i < entries; i++)
+    {
+        unsigned long symbol, freq;
+        if (!readRawDigits(archive, pos, D, symbol) || !readRawDigits(archive, pos, W, freq) ||
+            symbol == 0 || symbol > 255 || freq == 0 || freq > INT_MAX)
+        {
+            return false;
+        }
+        freqs.add(std::make_pair((char)symbol, (int)freq));
+    }
+    HuffmanTree<treeOrder> model;
+    if (freqs.size() > 0)
+    {
+        model.build(freqs);
+    }
+    if (!readRawDigits(archive, pos, W, codedCount))
+    {
+        return false;
+    }
+
+    // Giải mã Huffman, giải mã loạt số 0 và MTF ngược cùng lúc
+    std::string lastColumn;
+    unsigned long run = 0, weight = 1;
+    for (unsigned long i = 0; i <= codedCount; i++)
+    {
+        char symbol = '\0';
+        if (i < codedCount && !model.decodeSymbol(archive, pos, symbol))
+        {
+            return false;
+        }
+        if (symbol == BWT_RUN_A || symbol == BWT_RUN_B)
+        {
+            run += (symbol == BWT_RUN_A ? 1 : 2) * weight;
+            weight <<= 1;
+            if (run > length)
+                return false;
+            continue;
+        }
+        if (run > 0)
+        {
+            if (order.empty() || lastColumn.length() + run > length)
+                return false;
+            lastColumn.append(run, order[0]);
+            run = 0;
+            weight = 1;
+        }
+        if (i == codedCount)
+        {
+            break;
+        }
+        int j = (unsigned char)symbol - 2;
+        if (j < 1 || j >= (int)order.length() || lastColumn.length() >= length)
+        {
+            return false;
+        }
+        char ch = order[j];
+        order.erase(j, 1);
+        order.insert(order.begin(), ch);
+        lastColumn += ch;
+    }
+    if (lastColumn.length() != length)
+    {
+        return false;
+    }
+    return bwtInverse(lastColumn, (int)primaryIndex, block);
+}
+
+// Giải nén lưu trữ tạo bởi compressBlockSorted, thêm các sản phẩm giải mã vào hai danh sách đầu ra.
+// Các khối được giải nén lần lượt, sản phẩm được tách ngay khi đủ dòng (một dòng có thể vắt qua hai khối).
+// Trả về false nếu lưu trữ không hợp lệ
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::decompressBlockSorted(const std::string &archive,
+                                                           List2D<InventoryAttribute> &attributesOutput,
+                                                           List1D<std::string> &namesOutput)
+{
+    const int W = rawDigitCount(0xFFFFFFFFul);
+    size_t pos = 0;
+    unsigned long blockCount;
+    if (!readRawDigits(archive, pos, W, blockCount))
+    {
+        return false;
+    }
+
+    std::string text;
+    std::string block;
+    for (unsigned long b = 0; b < blockCount; b++)
+    {
+        if (!readSortedBlock(archive, pos, block))
+        {
+            return false;
+        }
+        text += block;
+
+        // Mỗi dòng là một sản phẩm
+        size_t start = 0, newline;
+        while ((newline = text.find('\n', start)) != std::string::npos)
+        {
+            List1D<InventoryAttribute> attributes;
+            std::string name;
+            parseProductString(unescapeRecordLine(text.substr(start, newline - start)), attributes, name);
+            attributesOutput.addRow(new List1D<InventoryAttribute>(attributes));
+            namesOutput.add(name);
+            start = newline + 1;
+        }
+        text.erase(0, start);
+    }
+    return true;
+}
+
+///////////////////// Lưu/nạp mô hình đã huấn luyện ////////////////////////
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::appendUInt32(std::string &out, unsigned int value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out += (char)((value >> (8 * i)) & 0xFF);
+    }
+}
+
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::readUInt32(const std::string &data, size_t &pos, unsigned int &value)
+{
+    if (pos + 4 > data.length())
+    {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        value |= (unsigned int)(unsigned char)data[pos++] << (8 * i);
+    }
+    return true;
+}
+
+// Ghi một cây kèm độ dài: [độ dài: 4 byte][hình dạng cây]
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::appendTree(std::string &out, const HuffmanTree<treeOrder> *model)
+{
+    std::string shape;
+    if (model != nullptr)
+    {
+        model->serialize(shape);
+    }
+    appendUInt32(out, (unsigned int)shape.length());
+    out += shape;
+}
+
+// Đọc một cây do appendTree ghi và sinh lại bảng mã tương ứng
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::readTree(const std::string &data, size_t &pos,
+                                               HuffmanTree<treeOrder> *&model, xMap<char, std::string> *table,
+                                               bool weighted)
+{
+    unsigned int length;
+    if (!readUInt32(data, pos, length) || pos + length > data.length())
+    {
+        return false;
+    }
+    if (model == nullptr)
+    {
+        model = new HuffmanTree<treeOrder>();
+    }
+    size_t end = pos + length;
+    if (!model->deserialize(data, pos, end, weighted))
+    {
+        return false;
+    }
+    table->clear();
+    if (!model->empty())
+    {
+        model->generateCodes(*table);
+    }
+    return true;
+}
+
+// Định dạng mô hình (nhị phân, số nguyên little-endian 4 byte):
+//   "HFMD" [phiên bản định dạng][treeOrder][cờ: 1 byte, bit 0 = có mô hình LZ77][cây chính]
+//   nếu có LZ77: [độ dài từ điển][từ điển][cây literal][cây độ dài][cây khoảng cách]
+//   [mã băm phiên bản: MurmurHash64A của toàn bộ phần trước, 8 byte]
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::exportModel() const
+{
+    std::string model(MODEL_MAGIC, 4);
+    appendUInt32(model, MODEL_FORMAT_VERSION);
+    appendUInt32(model, treeOrder);
+
+    bool hasLZ = lzEnabled && lzLiteralTree != nullptr;
+    model += (char)(hasLZ ? 1 : 0);
+    appendTree(model, tree);
+    if (hasLZ)
+    {
+        appendUInt32(model, (unsigned int)lzDictionary.length());
+        model += lzDictionary;
+        appendTree(model, lzLiteralTree);
+        appendTree(model, lzLengthTree);
+        appendTree(model, lzDistanceTree);
+    }
+
+    uint64_t version = MurmurHash64A(model.data(), (int)model.length(), 0);
+    for (int i = 0; i < 8; i++)
+    {
+        model += (char)((version >> (8 * i)) & 0xFF);
+    }
+    return model;
+}
+
+// Nạp mô hình do exportModel tạo ra. Trả về false (và giữ nguyên mô hình hiện tại) nếu dữ liệu
+// hỏng, sai phiên bản định dạng hoặc được huấn luyện cho treeOrder khác. Mô hình định dạng 1 (không có
+// tần suất lá) vẫn được nạp
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::importModel(const std::string &model)
+{
+    if (model.length() < 4 + 4 + 4 + 1 + 8 || model.compare(0, 4, MODEL_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+    size_t bodyLength = model.length() - 8;
+    uint64_t version = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        version |= (uint64_t)(unsigned char)model[bodyLength + i] << (8 * i);
+    }
+    if (version != MurmurHash64A(model.data(), (int)bodyLength, 0))
+    {
+        return false;
+    }
+
+    std::string body = model.substr(0, bodyLength);
+    size_t pos = 4;
+    unsigned int formatVersion, order;
+    if (!readUInt32(body, pos, formatVersion) || formatVersion < 1 || formatVersion > MODEL_FORMAT_VERSION ||
+        !readUInt32(body, pos, order) || order != (unsigned int)treeOrder || pos >= body.length())
+    {
+        return false;
+    }
+    bool hasLZ = body[pos++] != 0;
+
+    // Giải mã vào mô hình tạm rồi mới thay thế mô hình hiện tại
+    HuffmanTree<treeOrder> *mainTree = nullptr;
+    HuffmanTree<treeOrder> *literalTree = nullptr;
+    HuffmanTree<treeOrder> *lengthTree = nullptr;
+    HuffmanTree<treeOrder> *distanceTree = nullptr;
+    xMap<char, std::string> *mainTable = createCodeTable();
+    xMap<char, std::string> *literalTable = createCodeTable();
+    xMap<char, std::string> *lengthTable = createCodeTable();
+    xMap<char, std::string> *distanceTable = createCodeTable();
+    std::string dictionary;
+
+    bool weighted = formatVersion >= 2;
+    bool ok = readTree(body, pos, mainTree, mainTable, weighted);
+    if (ok && hasLZ)
+    {
+        unsigned int dictLength;
+        ok = readUInt32(body, pos, dictLength) && pos + dictLength <= body.length();
+        if (ok)
+        {
+            dictionary = body.substr(pos, dictLength);
+            pos += dictLength;
+            ok = readTree(body, pos, literalTree, literalTable, weighted) &&
+                 readTree(body, pos, lengthTree, lengthTable, weighted) &&
+                 readTree(body, pos, distanceTree, distanceTable, weighted);
+        }
+    }
+    ok = ok && pos == body.length();
+
+    if (!ok)
+    {
+        delete mainTree;
+        delete literalTree;
+        delete lengthTree;
+        delete distanceTree;
+        delete mainTable;
+        delete literalTable;
+        delete lengthTable;
+        delete distanceTable;
+        return false;
+    }
+
+    delete tree;
+    delete huffmanTable;
+    tree = mainTree;
+    huffmanTable = mainTable;
+
+    clearLZModels();
+    delete lzLiteralTable;
+    delete lzLengthTable;
+    delete lzDistanceTable;
+    lzLiteralTable = literalTable;
+    lzLengthTable = lengthTable;
+    lzDistanceTable = distanceTable;
+    rebuildFastTables();
+    lzEnabled = hasLZ;
+    if (hasLZ)
+    {
+        lzLiteralTree = literalTree;
+        lzLengthTree = lengthTree;
+        lzDistanceTree = distanceTree;
+        lzDictionary = dictionary;
+        buildLZDictionaryIndex();
+    }
+    return true;
+}
+
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::saveModel(const std::string &path) const
+{
+    std::ofstream file(path.c_str(), std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    std::string model = exportModel();
+    file.write(model.data(), model.length());
+    return (bool)file;
+}
+
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::loadModel(const std::string &path)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    std::string model((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return importModel(model);
+}
+
+// Mã băm phiên bản của mô hình hiện tại (trùng với 8 byte cuối của exportModel)
+template <int treeOrder>
+uint64_t InventoryCompressor<treeOrder>::getModelVersion() const
+{
+    std::string model = exportModel();
+    uint64_t version = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        version |= (uint64_t)(unsigned char)model[model.length() - 8 + i] << (8 * i);
+    }
+    return version;
+}
+
+///////////////////// Nhân mã hoá theo từ 8 byte ////////////////////////
+// Lấy byte thứ k (theo thứ tự trong bộ nhớ) của một từ 8 byte đã nạp bằng memcpy
+inline unsigned int wordByteAt(uint64_t word, int k)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return (unsigned int)(word >> (8 * (7 - k))) & 0xFF;
+#else
+    return (unsigned int)(word >> (8 * k)) & 0xFF;
+#endif
+}
+
+// Ghi một từ 64 bit theo thứ tự big-endian (byte cao nhất trước) bằng một lần ghi 8 byte
+inline void storeWordBigEndian(unsigned char *dst, uint64_t word)
+{
+#if !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    word = __builtin_bswap64(word);
+#endif
+    memcpy(dst, &word, 8);
+}
+
+// Dựng bảng mã phẳng từ huffmanTable: độ dài, vị trí trong vùng nhớ chung, ô chữ số cố định và dạng
+// đóng gói bit, rồi dựng lại máy trạng thái giải mã cho mô hình mới
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::rebuildFastTables()
+{
+    if (tree != nullptr)
+    {
+        tree->setLayoutOrder(treeLayout);
+    }
+    fastCodePool.clear();
+    fastMaxCodeLength = 0;
+    for (int c = 0; c < 256; c++)
+    {
+        fastCodeLength[c] = 0;
+        fastCodeOffset[c] = 0;
+        fastPackedEntry[c] = 0;
+        memset(fastCodeSlot[c], 0, FAST_SLOT_DIGITS);
+        if (!huffmanTable->containsKey((char)c))
+        {
+            continue;
+        }
+        std::string code = huffmanTable->get((char)c);
+        int length = (int)code.length();
+        fastCodeLength[c] = (unsigned short)length;
+        fastCodeOffset[c] = (int)fastCodePool.length();
+        fastCodePool += code;
+        if (length > fastMaxCodeLength)
+        {
+            fastMaxCodeLength = length;
+        }
+        memcpy(fastCodeSlot[c], code.data(), length < FAST_SLOT_DIGITS ? length : FAST_SLOT_DIGITS);
+        if (length > 0 && length * PACKED_DIGIT_BITS <= FAST_MAX_PACKED_BITS)
+        {
+            uint64_t bits = 0;
+            for (int i = 0; i < length; i++)
+            {
+                bits = (bits << PACKED_DIGIT_BITS) | (uint64_t)huffmanDigitValue(code[i]);
+            }
+            fastPackedEntry[c] = (bits << 8) | (uint64_t)(length * PACKED_DIGIT_BITS);
+        }
+    }
+    buildFSM();
+}
+
+// Nới out tới ít nhất need byte. Kích thước mới ước lượng theo tỉ lệ đầu ra / đầu vào của phần đã xử lý
+// (cộng 1/16 dự phòng) và không nhỏ hơn 1,5 lần kích thước cũ, nên thường chỉ nới một hai lần
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::growOutput(std::string &out, size_t need, size_t used, size_t processed,
+                                                size_t total)
+{
+    if (out.size() >= need)
+    {
+        return;
+    }
+    size_t size = out.size() + out.size() / 2;
+    if (processed > 0)
+    {
+        size_t estimate = (size_t)((double)used / processed * total * 1.0625);
+        if (estimate > size)
+            size = estimate;
+    }
+    out.resize(size > need ? size : need);
+}
+
+// Mã hoá thành chuỗi chữ số trong một lượt: nạp đầu vào theo từ 8 byte, với mỗi byte sao chép nguyên ô
+// FAST_SLOT_DIGITS chữ số (kích thước cố định, không cần vòng lặp theo độ dài) rồi tiến theo độ dài mã.
+// Chỗ trống ở đầu ra được kiểm tra một lần cho mỗi khối FAST_BLOCK_BYTES byte đầu vào.
+// Trả về false nếu gặp ký tự không có mã (để nơi gọi quay về đường chậm có cảnh báo)
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::encodeDigitsFast(const std::string &input, std::string &out) const
+{
+    const unsigned char *data = (const unsigned char *)input.data();
+    size_t n = input.length();
+    size_t worst = (size_t)(fastMaxCodeLength > FAST_SLOT_DIGITS ? fastMaxCodeLength : FAST_SLOT_DIGITS);
+    const char *pool = fastCodePool.data();
+
+    // dst truyền tường minh để nằm trong thanh ghi (lambda bắt tham chiếu buộc nó nằm trong bộ nhớ)
+    auto put = [this, pool](char *&dst, unsigned int c)
+    {
+        int length = fastCodeLength[c];
+        if (length <= FAST_SLOT_DIGITS)
+            memcpy(dst, fastCodeSlot[c], FAST_SLOT_DIGITS);
+        else
+            memcpy(dst, pool + fastCodeOffset[c], length);
+        dst += length;
+        return length != 0;
+    };
+
+    out.clear();
+    size_t used = 0;
+    size_t i = 0;
+    while (i < n)
+    {
+        size_t end = n - i < (size_t)FAST_BLOCK_BYTES ? n : i + FAST_BLOCK_BYTES;
+        growOutput(out, used + (end - i) * worst + FAST_SLOT_DIGITS, used, i, n);
+        char *dst = &out[0] + used;
+        for (; i + 8 <= end; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            for (int k = 0; k < 8; k++)
+            {
+                if (!put(dst, wordByteAt(word, k)))
+                    return false;
+            }
+        }
+        for (; i < end; i++)
+        {
+            if (!put(dst, data[i]))
+                return false;
+        }
+        used = dst - &out[0];
+    }
+    out.resize(used);
+    return true;
+}
+
+// Mã hoá thành chuỗi bit đóng gói (chữ số đầu tiên ở các bit cao của byte đầu tiên) trong một lượt.
+// Đầu vào được nạp theo từ 8 byte; mỗi cặp byte tra hai mục (mã, số bit), dồn cả hai vào thanh ghi 64 bit
+// rồi ghi một từ 8 byte không rẽ nhánh, con trỏ chỉ tiến theo số byte đầy. Mã dài hơn
+// FAST_MAX_PACKED_BITS bit được dồn từng chữ số. Trạng thái thanh ghi là biến cục bộ truyền tường minh
+// (không qua lambda bắt tham chiếu) để trình biên dịch giữ nó trong thanh ghi
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::encodePackedFast(const std::string &input, std::string &out, long &digitCount) const
+{
+    const unsigned char *data = (const unsigned char *)input.data();
+    size_t n = input.length();
+    size_t worstBits = (size_t)fastMaxCodeLength * PACKED_DIGIT_BITS;
+    const char *pool = fastCodePool.data();
+
+    // accBits luôn < 8 giữa hai lần ghi; phần đuôi chưa đầy của từ vừa ghi bị ghi đè ở lần sau
+    auto flush = [](uint64_t acc, int &accBits, unsigned char *&dst)
+    {
+        storeWordBigEndian(dst, acc << (64 - accBits));
+        dst += accBits >> 3;
+        accBits &= 7;
+    };
+    auto emit = [&flush, this, pool](uint64_t &acc, int &accBits, unsigned char *&dst, unsigned int c)
+    {
+        uint64_t entry = fastPackedEntry[c];
+        if (entry != 0)
+        {
+            acc = (acc << (entry & 0xFF)) | (entry >> 8);
+            accBits += (int)(entry & 0xFF);
+            flush(acc, accBits, dst);
+            return true;
+        }
+        const char *code = pool + fastCodeOffset[c];
+        for (int d = 0; d < fastCodeLength[c]; d++)
+        {
+            acc = (acc << PACKED_DIGIT_BITS) | (uint64_t)huffmanDigitValue(code[d]);
+            accBits += PACKED_DIGIT_BITS;
+            flush(acc, accBits, dst);
+        }
+        return fastCodeLength[c] != 0;
+    };
+
+    out.clear();
+    uint64_t acc = 0;
+    int accBits = 0;
+    size_t used = 0;
+    size_t i = 0;
+    while (i < n)
+    {
+        size_t end = n - i < (size_t)FAST_BLOCK_BYTES ? n : i + FAST_BLOCK_BYTES;
+        growOutput(out, used + ((end - i) * worstBits + 7) / 8 + 8, used, i, n);
+        unsigned char *dst = (unsigned char *)&out[0] + used;
+        for (; i + 8 <= end; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            for (int k = 0; k < 8; k += 2)
+            {
+                unsigned int c1 = wordByteAt(word, k);
+                unsigned int c2 = wordByteAt(word, k + 1);
+                uint64_t first = fastPackedEntry[c1];
+                uint64_t second = fastPackedEntry[c2];
+                if (first == 0 || second == 0)
+                {
+                    if (!emit(acc, accBits, dst, c1) || !emit(acc, accBits, dst, c2))
+                        return false;
+                    continue;
+                }
+                // Ghép hai mã trước (không phụ thuộc thanh ghi) để chuỗi phụ thuộc qua acc chỉ còn một
+                // phép dịch và một phép OR cho mỗi cặp
+                int pairBits = (int)(first & 0xFF) + (int)(second & 0xFF);
+                uint64_t pair = ((first >> 8) << (second & 0xFF)) | (second >> 8);
+                acc = (acc << pairBits) | pair;
+                accBits += pairBits;
+                flush(acc, accBits, dst);
+            }
+        }
+        for (; i < end; i++)
+        {
+            if (!emit(acc, accBits, dst, data[i]))
+                return false;
+        }
+        used = dst - (unsigned char *)&out[0];
+    }
+
+    // Byte cuối chưa đầy đã được lần ghi cuối cùng đặt đúng (các bit thừa bằng 0)
+    digitCount = (long)((used * 8 + accBits) / PACKED_DIGIT_BITS);
+    out.resize(used + (accBits > 0 ? 1 : 0));
+    return true;
+}
+
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::setTreeLayout(typename HuffmanTree<treeOrder>::LayoutOrder order)
+{
+    treeLayout = order;
+    if (tree != nullptr)
+    {
+        tree->setLayoutOrder(order);
+    }
+    buildFSM();
+}
+
+// Cùng kết quả với encodeHuffman nhưng dùng nhân mã hoá nhanh
+// Khi tầng LZ77 bật hoặc có ký tự không có mã, quay về encodeHuffman
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::encodeHuffmanFast(const List1D<InventoryAttribute> &attributes, const std::string &name)
+{
+    return encodeProductString(productToString(attributes, name));
+}
+
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::encodeProductString(const std::string &productStr) const
+{
+    std::string encodedString;
+    if (productStr.empty() || (!lzEnabled && encodeDigitsFast(productStr, encodedString)))
+    {
+        return encodedString;
+    }
+    if (lzEnabled)
+    {
+        return lzEncode(productStr);
+    }
+
+    // Có ký tự không có mã: bỏ qua kèm cảnh báo như encodeHuffman
+    for (size_t i = 0; i < productStr.length(); i++)
+    {
+        unsigned char c = (unsigned char)productStr[i];
+        if (fastCodeLength[c] == 0)
+        {
+            std::cerr << "Warning: Character '" << productStr[i] << "' not found in Huffman table" << std::endl;
+            continue;
+        }
+        encodedString.append(fastCodePool, fastCodeOffset[c], fastCodeLength[c]);
+    }
+    return encodedString;
+}
+
+// Mã hoá dạng đóng gói bit, digitCount nhận số chữ số Huffman (để bỏ qua phần đệm của byte cuối)
+// Ký tự không có mã bị bỏ qua kèm cảnh báo như encodeHuffman
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::encodeHuffmanPacked(const List1D<InventoryAttribute> &attributes,
+                                                                const std::string &name, long &digitCount)
+{
+    return encodeProductPacked(productToString(attributes, name), digitCount);
+}
+
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::encodeProductPacked(const std::string &productStr, long &digitCount) const
+{
+    std::string packed;
+    if (!encodePackedFast(productStr, packed, digitCount))
+    {
+        std::string filtered;
+        for (size_t i = 0; i < productStr.length(); i++)
+        {
+            if (fastCodeLength[(unsigned char)productStr[i]] == 0)
+            {
+                std::cerr << "Warning: Character '" << productStr[i] << "' not found in Huffman table" << std::endl;
+                continue;
+            }
+            filtered += productStr[i];
+        }
+        encodePackedFast(filtered, packed, digitCount);
+    }
+    return packed;
+}
+
+// Chuyển chuỗi bit đóng gói về chuỗi chữ số Huffman
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::unpackDigits(const std::string &packed, long digitCount)
+{
+    std::string digits;
+    if (digitCount <= 0 || (size_t)((digitCount * PACKED_DIGIT_BITS + 7) / 8) > packed.length())
+    {
+        return digits;
+    }
+    digits.resize(digitCount);
+    const unsigned char *data = (const unsigned char *)packed.data();
+    long bitPos = 0;
+    for (long d = 0; d < digitCount; d++, bitPos += PACKED_DIGIT_BITS)
+    {
+        int value = 0;
+        for (int b = 0; b < PACKED_DIGIT_BITS; b++)
+        {
+            long bit = bitPos + b;
+            value = (value << 1) | ((data[bit >> 3] >> (7 - (bit & 7))) & 1);
+        }
+        digits[d] = huffmanDigitChar(value);
+    }
+    return digits;
+}
+
+// Giải mã dạng đóng gói bit
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::decodeHuffmanPacked(const std::string &packed, long digitCount,
+                                                                List1D<InventoryAttribute> &attributesOutput,
+                                                                std::string &nameOutput)
+{
+    if (tree == nullptr)
+    {
+        return std::string();
+    }
+
+    std::string decodedText;
+    if (!FSM_SUPPORTED || !decodePackedFSM(packed, digitCount, decodedText))
+    {
+        // Bậc cây không chia hết byte (5..8) hoặc cây chỉ có một nút: giải mã từng chữ số
+        decodedText = tree->decode(unpackDigits(packed, digitCount));
+    }
+    if (decodedText.length() == 1 && decodedText[0] == '\0')
+    {
+        return std::string();
+    }
+
+    parseProductString(decodedText, attributesOutput, nameOutput);
+    return decodedText;
+}
+
+// Dựng bảng máy trạng thái từ cây: với mỗi nút trong và mỗi giá trị byte, đi hết các chữ số
+// của byte, ghi lại các ký tự gặp được và nút dừng lại
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::buildFSM()
+{
+    clearFSM();
+    if (tree == nullptr)
+    {
+        return;
+    }
+
+    XArrayList<int> transitions;
+    fsmStates = tree->flattenStates(transitions);
+    if (fsmStates == 0)
+    {
+        return;
+    }
+
+    fsmTransitions = new int[fsmStates * treeOrder];
+    for (int i = 0; i < fsmStates * treeOrder; i++)
+    {
+        fsmTransitions[i] = transitions.get(i);
+    }
+    if (!FSM_SUPPORTED)
+    {
+        return; // chỉ cần bảng chuyển từng chữ số (matchAttribute)
+    }
+
+    const int digitMask = (1 << PACKED_DIGIT_BITS) - 1;
+    fsmTable = new FSMEntry[fsmStates * 256];
+    for (int state = 0; state < fsmStates; state++)
+    {
+        for (int byte = 0; byte < 256; byte++)
+        {
+            FSMEntry &entry = fsmTable[state * 256 + byte];
+            entry.count = 0;
+            entry.invalid = false;
+            int current = state;
+            for (int d = 0; d < FSM_DIGITS_PER_BYTE; d++)
+            {
+                int digit = (byte >> (8 - PACKED_DIGIT_BITS * (d + 1))) & digitMask;
+                int next = digit < treeOrder ? fsmTransitions[current * treeOrder + digit] : HuffmanTree<treeOrder>::FLAT_INVALID;
+                if (next == HuffmanTree<treeOrder>::FLAT_INVALID)
+                {
+                    entry.invalid = true;
+                    break;
+                }
+                if (next < 0)
+                {
+                    entry.symbols[entry.count++] = (char)(-next - 1);
+                    current = 0;
+                }
+                else
+                {
+                    current = next;
+                }
+            }
+            entry.nextState = current;
+        }
+    }
+}
+
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::clearFSM()
+{
+    delete[] fsmTable;
+    delete[] fsmTransitions;
+    fsmTable = nullptr;
+    fsmTransitions = nullptr;
+    fsmStates = 0;
+}
+
+// Giải mã theo byte bằng bảng máy trạng thái; các chữ số của byte cuối chưa đầy đi qua bảng chuyển
+// từng chữ số. Trả về false nếu không dùng được máy trạng thái (cây một nút), decodedText nhận
+// "\0" nếu mã không hợp lệ như HuffmanTree::decode
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::decodePackedFSM(const std::string &packed, long digitCount, std::string &decodedText) const
+{
+    if (fsmTable == nullptr)
+    {
+        return false;
+    }
+
+    size_t needed = (size_t)((digitCount * PACKED_DIGIT_BITS + 7) / 8);
+    if (digitCount <= 0 || needed > packed.length())
+    {
+        decodedText = std::string(1, '\0');
+        return true;
+    }
+
+    // Mỗi ký tự tốn ít nhất một chữ số; 8 byte dự phòng cho lần chép cả khối ký hiệu của một bước
+    std::string buffer(digitCount + 8, '\0');
+    char *out = &buffer[0];
+    size_t length = 0;
+    const unsigned char *data = (const unsigned char *)packed.data();
+    long fullBytes = digitCount / FSM_DIGITS_PER_BYTE;
+    int state = 0;
+    for (long i = 0; i < fullBytes; i++)
+    {
+        const FSMEntry &entry = fsmTable[state * 256 + data[i]];
+        if (entry.invalid)
+        {
+            decodedText = std::string(1, '\0');
+            return true;
+        }
+        memcpy(out + length, entry.symbols, sizeof(entry.symbols));
+        length += entry.count;
+        state = entry.nextState;
+    }
+
+    const int digitMask = (1 << PACKED_DIGIT_BITS) - 1;
+    int tailDigits = (int)(digitCount % FSM_DIGITS_PER_BYTE);
+    for (int d = 0; d < tailDigits; d++)
+    {
+        int digit = (data[fullBytes] >> (8 - PACKED_DIGIT_BITS * (d + 1))) & digitMask;
+        int next = digit < treeOrder ? fsmTransitions[state * treeOrder + digit] : HuffmanTree<treeOrder>::FLAT_INVALID;
+        if (next == HuffmanTree<treeOrder>::FLAT_INVALID)
+        {
+            decodedText = std::string(1, '\0');
+            return true;
+        }
+        if (next < 0)
+        {
+            out[length++] = (char)(-next - 1);
+            state = 0;
+        }
+        else
+        {
+            state = next;
+        }
+    }
+
+    // Mã kết thúc giữa chừng một ký tự
+    if (state != 0)
+    {
+        decodedText = std::string(1, '\0');
+        return true;
+    }
+    buffer.resize(length);
+    decodedText.swap(buffer);
+    return true;
+}
+
+///////////////////// Mã hoá nhiều luồng xen kẽ ////////////////////////
+template <int treeOrder>
+void InventoryCompressor<treeOrder>::setStreamCount(int streamCount)
+{
+    if (streamCount <= 0 || streamCount > INTERLEAVE_MAX_STREAMS)
+    {
+        throw std::invalid_argument("Stream count must be in range [1, 255]");
+    }
+    interleaveStreams = streamCount;
+}
+
+// Lượt 1 tính độ dài từng luồng để ghi bảng nhảy, lượt 2 chép mã của mỗi ký tự vào con trỏ
+// của luồng tương ứng. Ký tự không có mã bị bỏ qua kèm cảnh báo như encodeHuffman
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::encodeHuffmanInterleaved(const List1D<InventoryAttribute> &attributes,
+                                                                     const std::string &name)
+{
+    std::string productStr = productToString(attributes, name);
+    std::string symbols;
+    symbols.reserve(productStr.length());
+    for (size_t i = 0; i < productStr.length(); i++)
+    {
+        if (fastCodeLength[(unsigned char)productStr[i]] == 0)
+        {
+            std::cerr << "Warning: Character '" << productStr[i] << "' not found in Huffman table" << std::endl;
+            continue;
+        }
+        symbols += productStr[i];
+    }
+
+    int streams = interleaveStreams;
+    size_t streamLength[INTERLEAVE_MAX_STREAMS] = {0};
+    for (size_t i = 0; i < symbols.length(); i++)
+    {
+        streamLength[i % streams] += fastCodeLength[(unsigned char)symbols[i]];
+    }
+
+    std::string block;
+    block += (char)streams;
+    appendUInt32(block, (unsigned int)symbols.length());
+    for (int s = 0; s < streams - 1; s++)
+    {
+        appendUInt32(block, (unsigned int)streamLength[s]);
+    }
+
+    size_t header = block.length();
+    size_t cursor[INTERLEAVE_MAX_STREAMS];
+    size_t total = 0;
+    for (int s = 0; s < streams; s++)
+    {
+        cursor[s] = header + total;
+        total += streamLength[s];
+    }
+    block.resize(header + total);
+
+    const char *pool = fastCodePool.data();
+    for (size_t i = 0; i < symbols.length(); i++)
+    {
+        unsigned char c = (unsigned char)symbols[i];
+        int s = (int)(i % streams);
+        memcpy(&block[cursor[s]], pool + fastCodeOffset[c], fastCodeLength[c]);
+        cursor[s] += fastCodeLength[c];
+    }
+    return block;
+}
+
+// Đọc bảng nhảy rồi giải mã theo vòng: mỗi vòng lấy đúng một ký tự từ mỗi luồng.
+// Trả về chuỗi rỗng nếu khối hỏng (bảng nhảy sai, mã vượt ra ngoài luồng của nó)
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::decodeHuffmanInterleaved(const std::string &block,
+                                                                     List1D<InventoryAttribute> &attributesOutput,
+                                                                     std::string &nameOutput)
+{
+    if (tree == nullptr || block.empty())
+    {
+        return std::string();
+    }
+
+    size_t pos = 0;
+    int streams = (unsigned char)block[pos++];
+    unsigned int symbolCount = 0;
+    if (streams == 0 || !readUInt32(block, pos, symbolCount))
+    {
+        return std::string();
+    }
+
+    size_t streamPos[INTERLEAVE_MAX_STREAMS];
+    size_t streamEnd[INTERLEAVE_MAX_STREAMS];
+    size_t header = pos + 4 * (size_t)(streams - 1);
+    size_t offset = header;
+    for (int s = 0; s < streams - 1; s++)
+    {
+        unsigned int length = 0;
+        if (!readUInt32(block, pos, length))
+        {
+            return std::string();
+        }
+        streamPos[s] = offset;
+        offset += length;
+        streamEnd[s] = offset;
+    }
+    if (header > block.length() || offset > block.length())
+    {
+        return std::string();
+    }
+    streamPos[streams - 1] = offset;
+    streamEnd[streams - 1] = block.length();
+
+    // Mỗi ký tự tốn ít nhất một chữ số, nên số ký tự không thể vượt quá số chữ số
+    if (symbolCount > block.length() - header)
+    {
+        return std::string();
+    }
+
+    std::string decodedText(symbolCount, '\0');
+    size_t rounds = symbolCount / streams;
+    int tail = (int)(symbolCount % streams);
+    size_t out = 0;
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (int s = 0; s < streams; s++)
+        {
+            if (!tree->decodeSymbol(block, streamPos[s], decodedText[out + s]) || streamPos[s] > streamEnd[s])
+            {
+                return std::string();
+            }
+        }
+        out += streams;
+    }
+    for (int s = 0; s < tail; s++)
+    {
+        if (!tree->decodeSymbol(block, streamPos[s], decodedText[out + s]) || streamPos[s] > streamEnd[s])
+        {
+            return std::string();
+        }
+    }
+    for (int s = 0; s < streams; s++)
+    {
+        if (streamPos[s] != streamEnd[s])
+        {
+            return std::string();
+        }
+    }
+
+    parseProductString(decodedText, attributesOutput, nameOutput);
+    return decodedText;
+}
+
+///////////////////// Bản ghi lưu nén (IRecordCodec) ////////////////////////
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::encodeRecord(const List1D<InventoryAttribute> &attributes,
+                                                         const std::string &name)
+{
+    XArrayList<long> starts;
+    std::string productStr = serializeProduct(attributes, name, &starts, true);
+    std::string packed;
+    long digitCount = 0;
+    std::string record;
+    if (tree == nullptr || !encodePackedFast(productStr, packed, digitCount))
+    {
+        record += RECORD_RAW;
+        record += productStr;
+        return record;
+    }
+
+    auto appendVarint = [&record](unsigned long value)
+    {
+        while (value >= 0x80)
+        {
+            record += (char)((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        record += (char)value;
+    };
+    record += RECORD_PACKED;
+    appendVarint((unsigned long)digitCount);
+    appendVarint((unsigned long)starts.size());
+    // Đổi vị trí ký tự thành vị trí chữ số bằng tổng độ dài mã của các ký tự đứng trước
+    long charPos = 0;
+    long digitPos = 0;
+    long previous = 0;
+    for (int i = 0; i < starts.size(); i++)
+    {
+        for (; charPos < starts.get(i); charPos++)
+        {
+            digitPos += fastCodeLength[(unsigned char)productStr[charPos]];
+        }
+        appendVarint((unsigned long)(digitPos - previous));
+        previous = digitPos;
+    }
+    record += packed;
+    return record;
+}
+
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::readVarint(const std::string &data, size_t &pos, unsigned long &value)
+{
+    value = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        if (pos >= data.length() || shift > 56)
+        {
+            return false;
+        }
+        unsigned char byte = (unsigned char)data[pos++];
+        value |= (unsigned long)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+}
+
+template <int treeOrder>
+bool InventoryCompressor<treeOrder>::decodeRecord(const std::string &record, List1D<InventoryAttribute> &attributes,
+                                                  std::string &name)
+{
+    if (record.empty())
+    {
+        return false;
+    }
+    if (record[0] == RECORD_RAW)
+    {
+        return parseProductString(record.substr(1), attributes, name);
+    }
+    if (record[0] != RECORD_PACKED)
+    {
+        return false;
+    }
+
+    size_t pos = 1;
+    unsigned long digitCount = 0;
+    unsigned long attributeCount = 0;
+    unsigned long offset = 0;
+    if (!readVarint(record, pos, digitCount) || !readVarint(record, pos, attributeCount))
+    {
+        return false;
+    }
+    for (unsigned long i = 0; i < attributeCount; i++)
+    {
+        if (!readVarint(record, pos, offset))
+        {
+            return false;
+        }
+    }
+    return !decodeHuffmanPacked(record.substr(pos), (long)digitCount, attributes, name).empty();
+}
+
+// Chữ số thứ index của dãy đóng gói (ghi từ bit cao), -1 nếu vượt quá dữ liệu
+template <int treeOrder>
+int InventoryCompressor<treeOrder>::packedDigitAt(const unsigned char *data, size_t length, long index)
+{
+    size_t bit = (size_t)index * PACKED_DIGIT_BITS;
+    size_t byte = bit / 8;
+    if (byte >= length)
+    {
+        return -1;
+    }
+    // Chữ số có thể vắt qua hai byte khi PACKED_DIGIT_BITS không chia hết 8
+    unsigned int window = (unsigned int)data[byte] << 8;
+    if (byte + 1 < length)
+    {
+        window |= data[byte + 1];
+    }
+    int shift = 16 - PACKED_DIGIT_BITS - (int)(bit % 8);
+    return (int)((window >> shift) & ((1u << PACKED_DIGIT_BITS) - 1));
+}
+
+template <int treeOrder>
+std::string InventoryCompressor<treeOrder>::encodeAttributeKey(const std::string &attributeName)
+{
+    std::string keyText = "(" + attributeName + ": ";
+    std::string key;
+    for (size_t i = 0; i < keyText.length(); i++)
+    {
+        unsigned char c = (unsigned char)keyText[i];
+        if (fastCodeLength[c] == 0)
+        {
+            return std::string(); // không bản ghi PACKED nào chứa được tên này
+        }
+        const char *code = fastCodePool.data() + fastCodeOffset[c];
+        for (int d = 0; d < fastCodeLength[c]; d++)
+        {
+            key += (char)huffmanDigitValue(code[d]);
+        }
+    }
+    return key;
+}
+
+// Trả về 1 nếu có thuộc tính trùng khoá với giá trị trong [minValue, maxValue], 0 nếu không,
+// -1 nếu bản ghi không truy vấn được trên dạng nén (RECORD_RAW) hoặc hỏng
+template <int treeOrder>
+int InventoryCompressor<treeOrder>::matchAttribute(const std::string &record, const std::string &key,
+                                                   double minValue, double maxValue)
+{
+    if (record.empty() || record[0] != RECORD_PACKED)
+    {
+        return -1;
+    }
+    size_t pos = 1;
+    unsigned long digitCount = 0;
+    unsigned long attributeCount = 0;
+    if (!readVarint(record, pos, digitCount) || !readVarint(record, pos, attributeCount))
+    {
+        return -1;
+    }
+    size_t offsetsStart = pos;
+    unsigned long delta = 0;
+    for (unsigned long i = 0; i < attributeCount; i++)
+    {
+        if (!readVarint(record, pos, delta))
+        {
+            return -1;
+        }
+    }
+    if (key.empty() || attributeCount == 0)
+    {
+        return 0;
+    }
+    if (fsmTransitions == nullptr)
+    {
+        return -1; // cây một nút
+    }
+
+    const unsigned char *data = (const unsigned char *)record.data() + pos;
+    size_t length = record.length() - pos;
+    const long keyLength = (long)key.length();
+    size_t offsetPos = offsetsStart;
+    long start = 0;
+    for (unsigned long i = 0; i < attributeCount; i++)
+    {
+        readVarint(record, offsetPos, delta);
+        start += (long)delta;
+        if (start + keyLength >= (long)digitCount)
+        {
+            break;
+        }
+        long d = 0;
+        while (d < keyLength && packedDigitAt(data, length, start + d) == (int)key[d])
+        {
+            d++;
+        }
+        if (d < keyLength)
+        {
+            continue;
+        }
+
+        // Giải mã trường số ngay sau khoá, dừng ở ")"
+        char value[64];
+        int valueLength = 0;
+        int state = 0;
+        bool closed = false;
+        for (long k = start + keyLength; k < (long)digitCount && !closed; k++)
+        {
+            int digit = packedDigitAt(data, length, k);
+            int next = digit >= 0 && digit < treeOrder ? fsmTransitions[state * treeOrder + digit]
+                                                       : HuffmanTree<treeOrder>::FLAT_INVALID;
+            if (next == HuffmanTree<treeOrder>::FLAT_INVALID)
+            {
+                return -1;
+            }
+            if (next >= 0)
+            {
+                state = next;
+                continue;
+            }
+            char symbol = (char)(-next - 1);
+            state = 0;
+            if (symbol == ')')
+            {
+                closed = true;
+            }
+            else if (valueLength < (int)sizeof(value) - 1)
+            {
+                value[valueLength++] = symbol;
+            }
+            else
+            {
+                return -1;
+            }
+        }
+        if (!closed)
+        {
+            return -1;
+        }
+        value[valueLength] = '\0';
+        char *end = nullptr;
+        double number = strtod(value, &end);
+        if (end == value)
+        {
+            return -1;
+        }
+        if (number >= minValue && number <= maxValue)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif // INVENTORY_COMPRESSOR_H
@@ -0,0 +1,390 @@
+#ifndef STREAMING_COMPRESSOR_H
+#define STREAMING_COMPRESSOR_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include "inventory.h"
+#include "inventory_compressor.h"
+#include "list/XArrayList.h"
+#include "hash/xMap.h"
+#include "util/MurmurHash2_64.h"
+
+// -------------------- StreamingCompressor --------------------
+// Nén một tệp kho hàng lớn hơn bộ nhớ mà không dựng InventoryManager. Tệp đầu vào gồm các dòng
+// bản ghi (xem parseInventoryRecord) và được đọc hai lượt, mỗi lượt theo lô tối đa batchSize dòng:
+//   lượt 1 đếm tần số ký tự của productToExactString để huấn luyện mô hình,
+//   lượt 2 mã hoá từng bản ghi và ghi ra tệp nén.
+// Bộ nhớ chỉ phụ thuộc batchSize và độ dài dòng, không phụ thuộc kích thước tệp. Giá trị thuộc tính
+// được lưu không làm tròn nên giải nén cho lại đúng các số đã đọc từ tệp.
+// Tệp nén: [magic "HFSA"][độ dài mô hình: 4 byte][mô hình (exportModel)] rồi mỗi bản ghi
+// [số lượng: 4 byte][số chữ số: 4 byte][mã Huffman đóng gói bit (encodeHuffmanPacked)]
+// Bản ghi trùng (cùng chuỗi productToExactString, số lượng có thể khác) chỉ được mã hoá một lần: bản sao
+// được ghi thành [số lượng: 4 byte][0: 4 byte][khoảng cách lùi tới trường số chữ số của bản gốc: 4 byte],
+// chỉ khi tham chiếu ngắn hơn mã đóng gói (bản ghi rất ngắn vẫn được mã hoá lại).
+// Dấu vân tay 128 bit là hai MurmurHash64A với hai seed; bảng dấu vân tay giữ tối đa dedupCapacity
+// bản ghi khác nhau để bộ nhớ vẫn bị chặn (bản ghi mới sau khi đầy được mã hoá bình thường)
+template <int treeOrder>
+class StreamingCompressor
+{
+public:
+    struct Stats
+    {
+        long records;
+        long skippedLines;  // dòng rỗng hoặc sai định dạng
+        long rawBytes;      // tổng độ dài chuỗi sản phẩm
+        long encodedDigits; // tổng số chữ số Huffman
+        long batches;       // số lô đã đọc (cả hai lượt)
+        long duplicates;    // bản ghi ghi dưới dạng tham chiếu tới bản gốc
+
+        double dedupHitRate() const { return records > 0 ? (double)duplicates / records : 0.0; }
+    };
+
+    static constexpr int DEFAULT_BATCH_SIZE = 4096;
+    static constexpr int DEFAULT_DEDUP_CAPACITY = 1 << 20;
+
+    StreamingCompressor(char delimiter = ',', int batchSize = DEFAULT_BATCH_SIZE);
+
+    bool compressFile(const std::string &inputPath, const std::string &archivePath, Stats &stats);
+    // Giải nén về tệp dòng bản ghi cùng định dạng đầu vào, cũng theo lô
+    bool decompressFile(const std::string &archivePath, const std::string &outputPath, Stats &stats);
+
+    // Số bản ghi khác nhau tối đa được nhớ để khử trùng lặp, 0 = tắt
+    void setDedupCapacity(int capacity);
+
+    // Bộ nén bên trong (mô hình của lần nén/giải nén gần nhất), dùng để giải mã từng bản ghi
+    InventoryCompressor<treeOrder> &getCompressor() { return compressor; }
+
+private:
+    char delimiter;
+    int batchSize;
+    int dedupCapacity;
+    InventoryCompressor<treeOrder> compressor;
+
+    struct Fingerprint
+    {
+        uint64_t low;
+        uint64_t high;
+        bool operator==(const Fingerprint &other) const { return low == other.low && high == other.high; }
+        // xMap yêu cầu in được khoá (thông báo lỗi KeyNotFound)
+        friend std::ostream &operator<<(std::ostream &os, const Fingerprint &key) { return os << std::hex << key.high << key.low << std::dec; }
+    };
+    static Fingerprint fingerprint(const std::string &productStr);
+    static int fingerprintHash(Fingerprint &key, int capacity) { return (int)(key.low % (uint64_t)capacity); }
+
+    // Bản ghi gốc: vị trí trường số chữ số trong tệp nén và số byte mã đóng gói
+    struct DedupEntry
+    {
+        long fieldPos;
+        long packedBytes;
+        bool operator==(const DedupEntry &other) const { return fieldPos == other.fieldPos; }
+        friend std::ostream &operator<<(std::ostream &os, const DedupEntry &entry) { return os << entry.fieldPos; }
+    };
+    static constexpr long DEDUP_REFERENCE_BYTES = 4;
+
+    static constexpr char ARCHIVE_MAGIC[5] = "HFSA";
+    bool readBatch(std::istream &in, XArrayList<std::string> &batch);
+    static void appendUInt32(std::string &out, unsigned int value);
+    static bool readUInt32(std::istream &in, unsigned int &value);
+};
+
+///////////////////////////// Triển khai StreamingCompressor ////////////////////////
+template <int treeOrder>
+StreamingCompressor<treeOrder>::StreamingCompressor(char delimiter, int batchSize)
+    : dedupCapacity(DEFAULT_DEDUP_CAPACITY), compressor(nullptr)
+{
+    if (batchSize <= 0)
+    {
+        throw std::invalid_argument("Batch size must be positive");
+    }
+    this->delimiter = delimiter;
+    this->batchSize = batchSize;
+}
+
+template <int treeOrder>
+void StreamingCompressor<treeOrder>::setDedupCapacity(int capacity)
+{
+    if (capacity < 0)
+    {
+        throw std::invalid_argument("Dedup capacity must not be negative");
+    }
+    dedupCapacity = capacity;
+}
+
+template <int treeOrder>
+typename StreamingCompressor<treeOrder>::Fingerprint StreamingCompressor<treeOrder>::fingerprint(const std::string &productStr)
+{
+    Fingerprint result;
+    result.low = MurmurHash64A(productStr.data(), (int)productStr.length(), 0);
+    result.high = MurmurHash64A(productStr.data(), (int)productStr.length(), 0x9747b28c);
+    return result;
+}
+
+template <int treeOrder>
+void StreamingCompressor<treeOrder>::appendUInt32(std::string &out, unsigned int value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out += (char)((value >> (8 * i)) & 0xFF);
+    }
+}
+
+template <int treeOrder>
+bool StreamingCompressor<treeOrder>::readUInt32(std::istream &in, unsigned int &value)
+{
+    char bytes[4];
+    if (!in.read(bytes, 4))
+    {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        value |= (unsigned int)(unsigned char)bytes[i] << (8 * i);
+    }
+    return true;
+}
+
+// Đọc tối đa batchSize dòng; trả về false khi đã hết tệp
+template <int treeOrder>
+bool StreamingCompressor<treeOrder>::readBatch(std::istream &in, XArrayList<std::string> &batch)
+{
+    batch.clear();
+    std::string line;
+    while (batch.size() < batchSize && std::getline(in, line))
+    {
+        batch.add(line);
+    }
+    return batch.size() > 0;
+}
+
+template <int treeOrder>
+bool StreamingCompressor<treeOrder>::compressFile(const std::string &inputPath, const std::string &archivePath,
+                                                  Stats &stats)
+{
+    stats = Stats{0, 0, 0, 0, 0, 0};
+    XArrayList<std::string> batch;
+    std::string name;
+    int quantity = 0;
+    List1D<InventoryAttribute> attributes;
+
+    // Lượt 1: đếm tần số ký tự
+    long counts[256] = {0};
+    {
+        std::ifstream in(inputPath.c_str(), std::ios::binary);
+        if (!in)
+        {
+            return false;
+        }
+        while (readBatch(in, batch))
+        {
+            stats.batches++;
+            for (int i = 0; i < batch.size(); i++)
+            {
+                if (!parseInventoryRecord(batch.get(i), delimiter, name, quantity, attributes))
+                {
+                    continue;
+                }
+                std::string productStr = compressor.productToExactString(attributes, name);
+                stats.rawBytes += (long)productStr.length();
+                for (size_t k = 0; k < productStr.length(); k++)
+                {
+                    counts[(unsigned char)productStr[k]]++;
+                }
+            }
+        }
+    }
+    compressor.buildHuffmanFromCounts(counts);
+
+    std::ofstream out(archivePath.c_str(), std::ios::binary);
+    if (!out)
+    {
+        return false;
+    }
+    std::string model = compressor.exportModel();
+    std::string header(ARCHIVE_MAGIC, 4);
+    appendUInt32(header, (unsigned int)model.length());
+    out << header << model;
+    long archivePos = (long)(header.length() + model.length());
+
+    xMap<Fingerprint, DedupEntry> seen(&fingerprintHash);
+
+    // Lượt 2: mã hoá, mỗi lô được ghi ra bằng một lần ghi
+    std::ifstream in(inputPath.c_str(), std::ios::binary);
+    if (!in)
+    {
+        return false;
+    }
+    std::string buffer;
+    std::string packed;
+    while (readBatch(in, batch))
+    {
+        stats.batches++;
+        buffer.clear();
+        for (int i = 0; i < batch.size(); i++)
+        {
+            if (!parseInventoryRecord(batch.get(i), delimiter, name, quantity, attributes))
+            {
+                stats.skippedLines++;
+                continue;
+            }
+            std::string productStr = compressor.productToExactString(attributes, name);
+            appendUInt32(buffer, (unsigned int)quantity);
+            long fieldPos = archivePos + (long)buffer.length();
+            stats.records++;
+
+            Fingerprint key = fingerprint(productStr);
+            bool known = dedupCapacity > 0 && seen.containsKey(key);
+            if (known)
+            {
+                DedupEntry &original = seen.get(key);
+                long distance = fieldPos - original.fieldPos;
+                if (original.packedBytes > DEDUP_REFERENCE_BYTES && distance <= 0xFFFFFFFFL)
+                {
+                    appendUInt32(buffer, 0);
+                    appendUInt32(buffer, (unsigned int)distance);
+                    stats.duplicates++;
+                    continue;
+                }
+            }
+
+            long digitCount = 0;
+            packed = compressor.encodeProductPacked(productStr, digitCount);
+            if (!known && seen.size() < dedupCapacity)
+            {
+                seen.put(key, DedupEntry{fieldPos, (long)packed.length()});
+            }
+            appendUInt32(buffer, (unsigned int)digitCount);
+            buffer += packed;
+            stats.encodedDigits += digitCount;
+        }
+        archivePos += (long)buffer.length();
+        out << buffer;
+        if (!out)
+        {
+            return false;
+        }
+    }
+    out.flush();
+    return (bool)out;
+}
+
+template <int treeOrder>
+bool StreamingCompressor<treeOrder>::decompressFile(const std::string &archivePath, const std::string &outputPath,
+                                                    Stats &stats)
+{
+    stats = Stats{0, 0, 0, 0, 0, 0};
+    std::ifstream in(archivePath.c_str(), std::ios::binary);
+    if (!in)
+    {
+        return false;
+    }
+
+    char magic[4];
+    unsigned int modelLength = 0;
+    if (!in.read(magic, 4) || std::string(magic, 4) != std::string(ARCHIVE_MAGIC, 4) || !readUInt32(in, modelLength))
+    {
+        return false;
+    }
+    std::string model(modelLength, '\0');
+    if (modelLength > 0 && !in.read(&model[0], modelLength))
+    {
+        return false;
+    }
+    if (!compressor.importModel(model))
+    {
+        return false;
+    }
+
+    std::ofstream out(outputPath.c_str(), std::ios::binary);
+    if (!out)
+    {
+        return false;
+    }
+
+    // Đọc theo lô batchSize bản ghi; mỗi bản ghi chỉ cần phần đóng gói của chính nó trong bộ nhớ
+    const int bits = InventoryCompressor<treeOrder>::PACKED_DIGIT_BITS;
+    std::string buffer;
+    std::string packed;
+    bool more = true;
+    while (more)
+    {
+        buffer.clear();
+        int inBatch = 0;
+        while (inBatch < batchSize)
+        {
+            unsigned int quantity = 0;
+            unsigned int digitCount = 0;
+            if (!readUInt32(in, quantity))
+            {
+                if (in.gcount() != 0)
+                {
+                    return false; // bản ghi cuối bị cắt cụt
+                }
+                more = false;
+                break;
+            }
+            if (!readUInt32(in, digitCount))
+            {
+                return false;
+            }
+            if (digitCount == 0)
+            {
+                // Bản sao: đọc lại bản gốc đã ghi phía trước rồi quay về vị trí hiện tại
+                unsigned int distance = 0;
+                if (!readUInt32(in, distance))
+                {
+                    return false;
+                }
+                std::streampos resume = in.tellg();
+                std::streamoff original = (std::streamoff)resume - 8 - (std::streamoff)distance;
+                if (distance == 0 || original < 0 || !in.seekg(original) || !readUInt32(in, digitCount) || digitCount == 0)
+                {
+                    return false;
+                }
+                packed.resize(((size_t)digitCount * bits + 7) / 8);
+                if (!in.read(&packed[0], packed.length()) || !in.seekg(resume))
+                {
+                    return false;
+                }
+                stats.duplicates++;
+            }
+            else
+            {
+                packed.resize(((size_t)digitCount * bits + 7) / 8);
+                if (!in.read(&packed[0], packed.length()))
+                {
+                    return false;
+                }
+            }
+
+            List1D<InventoryAttribute> attributes;
+            std::string name;
+            std::string productStr = compressor.decodeHuffmanPacked(packed, digitCount, attributes, name);
+            if (productStr.empty())
+            {
+                return false;
+            }
+            buffer += formatInventoryRecord(name, (int)quantity, attributes, delimiter);
+            buffer += '\n';
+            inBatch++;
+            stats.records++;
+            stats.rawBytes += (long)productStr.length();
+            stats.encodedDigits += digitCount;
+        }
+        if (inBatch > 0)
+        {
+            stats.batches++;
+        }
+        out << buffer;
+        if (!out)
+        {
+            return false;
+        }
+    }
+    out.flush();
+    return (bool)out;
+}
+
+#endif // STREAMING_COMPRESSOR_H
@@ -19,6 +19,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "heap/IHeap.h"
 #include "list/XArrayList.h"
@@ -519,8 +520,9 @@ void Heap<T>::remove_bck(T item, void (*removeItemData)(T)){
     if(removeItemData != 0) removeItemData(elements[foundIdx]);
 
     //Remove item: shift left
-    int copyCount = (count - 1) - (foundIdx + 1) + 1;
-    memcpy(&elements[foundIdx], &elements[foundIdx + 1], copyCount*sizeof(T));
+    // Dời từng phần tử (không memcpy) để T như string vẫn đúng
+    for(int idx = foundIdx; idx < count - 1; idx++)
+        elements[idx] = std::move(elements[idx + 1]);
     count -= 1;
 
     //Determine valid heap [0-> (new size -1)]
@@ -547,11 +549,14 @@ void Heap<T>::ensureCapacity(int minCapacity)
     // Cấp phát lại
     int old_capacity = capacity;
     capacity = old_capacity + (old_capacity >> 2); // Tăng kích thước 1.25 lần
+    if (capacity <= minCapacity)
+      capacity = minCapacity + 1; // heapify/heapsort có thể cần nhiều hơn 1.25 lần
     try
     {
       T *new_data = new T[capacity]; // Tạo mảng mới
-      // Sao chép dữ liệu cũ sang mảng mới
-      memcpy(new_data, elements, old_capacity * sizeof(T));
+      // Chuyển dữ liệu cũ sang mảng mới từng phần tử (memcpy chỉ đúng với kiểu sao chép bit được)
+      for (int idx = 0; idx < count; idx++)
+        new_data[idx] = std::move(elements[idx]);
       delete[] elements;   // Xóa mảng cũ
       elements = new_data; // Gán mảng mới
     }
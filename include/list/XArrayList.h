@@ -54,6 +54,15 @@ public:
     string toString(string (*item2str)(T &) = 0);
     // Inherit from IList: BEGIN
 
+    // Cấp phát trước đủ chỗ cho capacity phần tử (không làm thay đổi size)
+    void reserve(int capacity)
+    {
+        if (capacity > 0)
+        {
+            ensureCapacity(capacity - 1);
+        }
+    }
+
     void println(string (*item2str)(T &) = 0)
     {
         cout << toString(item2str) << endl;
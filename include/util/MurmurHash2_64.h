@@ -6,9 +6,14 @@
 
 //typedef unsigned __int64 uint64_t;
 
+#ifndef MURMURHASH2_64_H
+#define MURMURHASH2_64_H
+
+#include <stdint.h>
+
 // 64-bit hash for 64-bit platforms
 
-uint64_t MurmurHash64A ( const void * key, int len, unsigned int seed )
+inline uint64_t MurmurHash64A ( const void * key, int len, unsigned int seed )
 {
 	const uint64_t m = 0xc6a4a7935bd1e995;
 	const int r = 47;
@@ -54,7 +59,7 @@ uint64_t MurmurHash64A ( const void * key, int len, unsigned int seed )
 
 // 64-bit hash for 32-bit platforms
 
-uint64_t MurmurHash64B ( const void * key, int len, unsigned int seed )
+inline uint64_t MurmurHash64B ( const void * key, int len, unsigned int seed )
 {
 	const unsigned int m = 0x5bd1e995;
 	const int r = 24;
@@ -103,4 +108,6 @@ uint64_t MurmurHash64B ( const void * key, int len, unsigned int seed )
 	h = (h << 32) | h2;
 
 	return h;
-} 
+}
+
+#endif /* MURMURHASH2_64_H */
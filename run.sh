@@ -1,2 +1,2 @@
-g++ -g -I include -I src -std=c++17 src/test/* src/main.cpp -o main 
+g++ -g -pthread -I include -I src -std=c++17 src/test/* src/main.cpp -o main 
 && ./main
\ No newline at end of file
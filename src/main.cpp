@@ -10,6 +10,12 @@ All in one
 #include "heap/Heap.h"
 #include "hash/xMap.h"
 #include "app/inventory_compressor.h"
+#include "app/compression_pipeline.h"
+#include "app/streaming_compressor.h"
+#include "app/concurrent_inventory.h"
+#include <thread>
+#include <fstream>
+#include <cstdio>
 
 using namespace std;
 
@@ -1641,6 +1647,1154 @@ void compressor090()
     cout << AttributeOutput.toString() << ": " << name << endl;
 }
 
+void compressor091()
+{
+    expect = "Acme Power Saw 500W [weight: 3.5, voltage: 12]\nshorter: 1\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> drillAttrs;
+    drillAttrs.add(InventoryAttribute("weight", 2.5));
+    drillAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(drillAttrs, "Acme Power Drill 500W", 3);
+
+    List1D<InventoryAttribute> sawAttrs;
+    sawAttrs.add(InventoryAttribute("weight", 3.5));
+    sawAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(sawAttrs, "Acme Power Saw 500W", 2);
+
+    InventoryCompressor<4> plain(&manager);
+    plain.buildHuffman();
+    InventoryCompressor<4> compressor(&manager);
+    compressor.setLZ77Enabled(true);
+    compressor.buildHuffman();
+
+    string encoded = compressor.encodeHuffman(sawAttrs, "Acme Power Saw 500W");
+    List1D<InventoryAttribute> AttributeOutput;
+    string name = "";
+    compressor.decodeHuffman(encoded, AttributeOutput, name);
+    cout << name << " " << AttributeOutput.toString() << endl;
+    cout << "shorter: " << (encoded.length() < plain.encodeHuffman(sawAttrs, "Acme Power Saw 500W").length()) << endl;
+}
+
+void compressor092()
+{
+    expect = "Car [speed: 88]\nBattery [capacity: 250, voltage: 12]\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> carAttrs;
+    carAttrs.add(InventoryAttribute("speed", 88.0));
+    manager.addProduct(carAttrs, "Car", 1);
+
+    List1D<InventoryAttribute> batteryAttrs;
+    batteryAttrs.add(InventoryAttribute("capacity", 250.0));
+    batteryAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(batteryAttrs, "Battery", 5);
+
+    InventoryCompressor<3> compressor(&manager);
+    compressor.setBlockSize(16);
+    string archive = compressor.compressBlockSorted();
+
+    List2D<InventoryAttribute> attributesOutput;
+    List1D<string> namesOutput;
+    compressor.decompressBlockSorted(archive, attributesOutput, namesOutput);
+    for (int i = 0; i < namesOutput.size(); i++)
+    {
+        cout << namesOutput.get(i) << " " << attributesOutput.getRow(i).toString() << endl;
+    }
+}
+
+void compressor093()
+{
+    expect = "loaded: 1\nsame code: 1\nBattery\nwrong order: 0\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> carAttrs;
+    carAttrs.add(InventoryAttribute("speed", 88.0));
+    manager.addProduct(carAttrs, "Car", 1);
+
+    List1D<InventoryAttribute> batteryAttrs;
+    batteryAttrs.add(InventoryAttribute("capacity", 250.0));
+    batteryAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(batteryAttrs, "Battery", 5);
+
+    InventoryCompressor<5> trained(&manager);
+    trained.buildHuffman();
+    string model = trained.exportModel();
+
+    InventoryManager emptyManager;
+    InventoryCompressor<5> compressor(&emptyManager);
+    cout << "loaded: " << compressor.importModel(model) << endl;
+
+    string encoded = compressor.encodeHuffman(batteryAttrs, "Battery");
+    cout << "same code: " << (encoded == trained.encodeHuffman(batteryAttrs, "Battery")) << endl;
+    List1D<InventoryAttribute> AttributeOutput;
+    string name = "";
+    compressor.decodeHuffman(encoded, AttributeOutput, name);
+    cout << name << endl;
+
+    InventoryCompressor<4> other(&emptyManager);
+    cout << "wrong order: " << other.importModel(model) << endl;
+}
+
+void compressor094()
+{
+    expect = "sampled: 2\nheld out: 2\nloss >= 0: 1\nZebra #9 [width: 7]\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> carAttrs;
+    carAttrs.add(InventoryAttribute("speed", 88.0));
+    manager.addProduct(carAttrs, "Car", 1);
+    manager.addProduct(carAttrs, "Car", 2);
+
+    List1D<InventoryAttribute> batteryAttrs;
+    batteryAttrs.add(InventoryAttribute("capacity", 250.0));
+    batteryAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(batteryAttrs, "Battery", 5);
+    manager.addProduct(batteryAttrs, "Battery", 6);
+
+    InventoryCompressor<3> compressor(&manager);
+    InventoryCompressor<3>::SamplingReport report = compressor.buildHuffmanSampled(0.5, true, 1, 7);
+    cout << "sampled: " << report.sampledProducts << endl;
+    cout << "held out: " << report.heldOutProducts << endl;
+    cout << "loss >= 0: " << (report.estimatedLossPercent >= 0.0) << endl;
+
+    // Ký tự chưa từng xuất hiện vẫn mã hoá được nhờ sàn tần số
+    List1D<InventoryAttribute> zebraAttrs;
+    zebraAttrs.add(InventoryAttribute("width", 7.0));
+    string encoded = compressor.encodeHuffman(zebraAttrs, "Zebra #9");
+    List1D<InventoryAttribute> AttributeOutput;
+    string name = "";
+    compressor.decodeHuffman(encoded, AttributeOutput, name);
+    cout << name << " " << AttributeOutput.toString() << endl;
+}
+
+void compressor095()
+{
+    expect = "same code: 1\npacked bytes: 12\nunpacked: 1\nCar [speed: 88]\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> carAttrs;
+    carAttrs.add(InventoryAttribute("speed", 88.0));
+    manager.addProduct(carAttrs, "Car", 1);
+
+    List1D<InventoryAttribute> batteryAttrs;
+    batteryAttrs.add(InventoryAttribute("capacity", 250.0));
+    batteryAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(batteryAttrs, "Battery", 5);
+
+    InventoryCompressor<4> compressor(&manager);
+    compressor.buildHuffman();
+    string encoded = compressor.encodeHuffman(carAttrs, "Car");
+    cout << "same code: " << (compressor.encodeHuffmanFast(carAttrs, "Car") == encoded) << endl;
+
+    long digitCount = 0;
+    string packed = compressor.encodeHuffmanPacked(carAttrs, "Car", digitCount);
+    cout << "packed bytes: " << packed.length() << endl;
+    cout << "unpacked: " << (InventoryCompressor<4>::unpackDigits(packed, digitCount) == encoded) << endl;
+
+    List1D<InventoryAttribute> AttributeOutput;
+    string name = "";
+    compressor.decodeHuffmanPacked(packed, digitCount, AttributeOutput, name);
+    cout << name << " " << AttributeOutput.toString() << endl;
+}
+
+void compressor096()
+{
+    expect = "streams: 3\nheader: 13\nBattery [capacity: 250, voltage: 12]\ncorrupt: 1\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> batteryAttrs;
+    batteryAttrs.add(InventoryAttribute("capacity", 250.0));
+    batteryAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(batteryAttrs, "Battery", 5);
+
+    InventoryCompressor<3> compressor(&manager);
+    compressor.buildHuffman();
+    compressor.setStreamCount(3);
+    cout << "streams: " << compressor.getStreamCount() << endl;
+
+    string block = compressor.encodeHuffmanInterleaved(batteryAttrs, "Battery");
+    string encoded = compressor.encodeHuffman(batteryAttrs, "Battery");
+    cout << "header: " << block.length() - encoded.length() << endl;
+
+    List1D<InventoryAttribute> AttributeOutput;
+    string name = "";
+    compressor.decodeHuffmanInterleaved(block, AttributeOutput, name);
+    cout << name << " " << AttributeOutput.toString() << endl;
+
+    List1D<InventoryAttribute> corruptOutput;
+    string corruptName = "";
+    cout << "corrupt: " << compressor.decodeHuffmanInterleaved(block.substr(0, block.length() - 1), corruptOutput, corruptName).empty() << endl;
+}
+
+void compressor097()
+{
+    expect = "Battery [capacity: 250, voltage: 12]\ntruncated: 1\nBattery [capacity: 250, voltage: 12]\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> batteryAttrs;
+    batteryAttrs.add(InventoryAttribute("capacity", 250.0));
+    batteryAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(batteryAttrs, "Battery", 5);
+
+    InventoryCompressor<2> compressor(&manager);
+    compressor.buildHuffman();
+    long digitCount = 0;
+    string packed = compressor.encodeHuffmanPacked(batteryAttrs, "Battery", digitCount);
+
+    List1D<InventoryAttribute> AttributeOutput;
+    string name = "";
+    compressor.decodeHuffmanPacked(packed, digitCount, AttributeOutput, name);
+    cout << name << " " << AttributeOutput.toString() << endl;
+
+    List1D<InventoryAttribute> truncatedOutput;
+    string truncatedName = "";
+    cout << "truncated: " << compressor.decodeHuffmanPacked(packed, digitCount - 1, truncatedOutput, truncatedName).empty() << endl;
+
+    // Bậc 5 không chia hết byte: quay về giải mã từng chữ số
+    InventoryCompressor<5> fallback(&manager);
+    fallback.buildHuffman();
+    packed = fallback.encodeHuffmanPacked(batteryAttrs, "Battery", digitCount);
+    List1D<InventoryAttribute> fallbackOutput;
+    string fallbackName = "";
+    fallback.decodeHuffmanPacked(packed, digitCount, fallbackOutput, fallbackName);
+    cout << fallbackName << " " << fallbackOutput.toString() << endl;
+}
+
+void compressor098()
+{
+    expect = "records: 3\nsame as encodeHuffman: 1\nCar [speed: 88]\nBattery [capacity: 250, voltage: 12]\nLamp [power: 40]\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> carAttrs;
+    carAttrs.add(InventoryAttribute("speed", 88.0));
+    manager.addProduct(carAttrs, "Car", 1);
+    List1D<InventoryAttribute> batteryAttrs;
+    batteryAttrs.add(InventoryAttribute("capacity", 250.0));
+    batteryAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(batteryAttrs, "Battery", 5);
+    List1D<InventoryAttribute> lampAttrs;
+    lampAttrs.add(InventoryAttribute("power", 40.0));
+    manager.addProduct(lampAttrs, "Lamp", 2);
+
+    InventoryCompressor<4> compressor(&manager);
+    compressor.buildHuffman();
+    CompressionPipeline<4> pipeline(&manager, &compressor, 1);
+    stringstream archive;
+    CompressionPipeline<4>::Stats stats = pipeline.run(archive);
+    cout << "records: " << stats.records << endl;
+
+    string line;
+    getline(archive, line);
+    cout << "same as encodeHuffman: " << (line == compressor.encodeHuffman(carAttrs, "Car")) << endl;
+    archive.seekg(0);
+    while (getline(archive, line))
+    {
+        List1D<InventoryAttribute> AttributeOutput;
+        string name = "";
+        compressor.decodeHuffman(line, AttributeOutput, name);
+        cout << name << " " << AttributeOutput.toString() << endl;
+    }
+}
+
+void compressor099()
+{
+    expect = "states: 5 5\nroot first: 1 1\nreordered: 1\nhot: Battery [capacity: 250, voltage: 12]\nbfs: Battery [capacity: 250, voltage: 12]\n";
+    XArrayList<pair<char, int>> symbolsFreqs;
+    symbolsFreqs.add(make_pair('a', 40));
+    symbolsFreqs.add(make_pair('b', 3));
+    symbolsFreqs.add(make_pair('c', 2));
+    symbolsFreqs.add(make_pair('d', 2));
+    symbolsFreqs.add(make_pair('e', 1));
+    symbolsFreqs.add(make_pair('f', 1));
+    HuffmanTree<2> tree;
+    tree.build(symbolsFreqs);
+    XArrayList<int> bfs, hot;
+    int bfsStates = tree.flattenStates(bfs);
+    tree.setLayoutOrder(HuffmanTree<2>::HOT_FIRST);
+    int hotStates = tree.flattenStates(hot);
+    cout << "states: " << bfsStates << " " << hotStates << endl;
+    cout << "root first: " << (bfs.get(0) == -('a' + 1) || bfs.get(1) == -('a' + 1)) << " "
+         << (hot.get(0) == -('a' + 1) || hot.get(1) == -('a' + 1)) << endl;
+    bool reordered = false;
+    for (int i = 0; i < bfs.size(); i++)
+    {
+        reordered = reordered || bfs.get(i) != hot.get(i);
+    }
+    cout << "reordered: " << reordered << endl;
+
+    InventoryManager manager;
+    List1D<InventoryAttribute> batteryAttrs;
+    batteryAttrs.add(InventoryAttribute("capacity", 250.0));
+    batteryAttrs.add(InventoryAttribute("voltage", 12.0));
+    manager.addProduct(batteryAttrs, "Battery", 5);
+
+    InventoryCompressor<3> compressor(&manager);
+    compressor.buildHuffman();
+    string encoded = compressor.encodeHuffman(batteryAttrs, "Battery");
+    compressor.setTreeLayout(HuffmanTree<3>::HOT_FIRST);
+    List1D<InventoryAttribute> hotOutput;
+    string hotName = "";
+    compressor.decodeHuffman(encoded, hotOutput, hotName);
+    cout << "hot: " << hotName << " " << hotOutput.toString() << endl;
+
+    compressor.setTreeLayout(HuffmanTree<3>::BREADTH_FIRST);
+    List1D<InventoryAttribute> bfsOutput;
+    string bfsName = "";
+    compressor.decodeHuffman(encoded, bfsOutput, bfsName);
+    cout << "bfs: " << bfsName << " " << bfsOutput.toString() << endl;
+}
+
+void compressor100()
+{
+    expect = "compressed: 1 records: 3 skipped: 1 batches: 4\ndecompressed: 1 records: 3\nCar\t1\tspeed=88\nBattery\t5\tcapacity=250\tvoltage=12\nLamp\t2\n";
+    const char *inputPath = "streaming_input.tsv";
+    const char *archivePath = "streaming_archive.hfsa";
+    const char *outputPath = "streaming_output.tsv";
+    {
+        ofstream input(inputPath);
+        input << "Car\t1\tspeed=88\n";
+        input << "Battery\t5\tcapacity=250\tvoltage=12\n";
+        input << "not a record\n";
+        input << "Lamp\t2\n";
+    }
+
+    // Lô 2 dòng: mỗi lượt đọc 2 lô
+    StreamingCompressor<3> compressor('\t', 2);
+    StreamingCompressor<3>::Stats stats;
+    bool ok = compressor.compressFile(inputPath, archivePath, stats);
+    cout << "compressed: " << ok << " records: " << stats.records << " skipped: " << stats.skippedLines
+         << " batches: " << stats.batches << endl;
+
+    StreamingCompressor<3> decompressor('\t', 2);
+    ok = decompressor.decompressFile(archivePath, outputPath, stats);
+    cout << "decompressed: " << ok << " records: " << stats.records << endl;
+    ifstream output(outputPath);
+    string line;
+    while (getline(output, line))
+    {
+        cout << line << endl;
+    }
+    output.close();
+
+    remove(inputPath);
+    remove(archivePath);
+    remove(outputPath);
+}
+
+void compressor101()
+{
+    expect = "loaded: 3\nsize: 4\nCar [speed: 88] 1\nBattery [capacity: 250, voltage: 12] 5\nLamp [] 2\nFan [power: 35.5] 7\nmissing: -1\n";
+    const char *inputPath = "bulk_input.csv";
+    {
+        ofstream input(inputPath);
+        input << "Battery,5,capacity=250,voltage=12\r\n";
+        input << "broken,line,x\n";
+        input << "Lamp,2\n";
+        input << "\n";
+        input << "Fan,7,power=35.5";
+    }
+
+    InventoryManager manager;
+    List1D<InventoryAttribute> carAttrs;
+    carAttrs.add(InventoryAttribute("speed", 88.0));
+    manager.addProduct(carAttrs, "Car", 1);
+
+    cout << "loaded: " << manager.loadFromFile(inputPath, ',', 2) << endl;
+    cout << "size: " << manager.size() << endl;
+    for (int i = 0; i < manager.size(); i++)
+    {
+        cout << manager.getProductName(i) << " " << manager.getProductAttributes(i) << " " << manager.getProductQuantity(i) << endl;
+    }
+    cout << "missing: " << manager.loadFromFile("no_such_inventory.csv") << endl;
+    remove(inputPath);
+}
+
+void compressor102()
+{
+    expect = "compressed: 1\nsame: 1\nsmaller: 1\nGadget [weight: 2.5, color: 3] 7\nquery: [Gadget, Zed#]\nafter remove: 3 Zed# [weight: 2.75]\nplain: 0 3 Zed#\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> attrs1;
+    attrs1.add(InventoryAttribute("weight", 1.5));
+    attrs1.add(InventoryAttribute("color", 2));
+    manager.addProduct(attrs1, "Widget", 10);
+    List1D<InventoryAttribute> attrs2;
+    attrs2.add(InventoryAttribute("weight", 2.5));
+    attrs2.add(InventoryAttribute("color", 3));
+    manager.addProduct(attrs2, "Gadget", 7);
+    List1D<InventoryAttribute> attrs3;
+    attrs3.add(InventoryAttribute("color", 1));
+    manager.addProduct(attrs3, "Widget", 4);
+
+    InventoryCompressor<4> compressor(&manager);
+    compressor.buildHuffman();
+    string before = manager.toString();
+    manager.enableCompressedStorage(&compressor, 2);
+    cout << "compressed: " << manager.isCompressedStorage() << endl;
+    cout << "same: " << (manager.toString() == before) << endl;
+    cout << "smaller: " << (manager.compressedBytes() < (long)before.length()) << endl;
+    cout << manager.getProductName(1) << " " << manager.getProductAttributes(1) << " " << manager.getProductQuantity(1) << endl;
+
+    // Ký tự không có trong mô hình: bản ghi được lưu nguyên văn
+    List1D<InventoryAttribute> attrs4;
+    attrs4.add(InventoryAttribute("weight", 2.75));
+    manager.addProduct(attrs4, "Zed#", 1);
+    cout << "query: " << manager.query("weight", 2.0, 3.0, 0, 100) << endl;
+    manager.removeProduct(0);
+    cout << "after remove: " << manager.size() << " " << manager.getProductName(2) << " " << manager.getProductAttributes(2) << endl;
+
+    manager.disableCompressedStorage();
+    cout << "plain: " << manager.isCompressedStorage() << " " << manager.size() << " " << manager.getProductName(2) << endl;
+}
+
+void compressor103()
+{
+    expect = "same: 1\n[Gadget, Zed#]\nmatch: 1 0 0 -1\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> attrs1;
+    attrs1.add(InventoryAttribute("weight", 1.5));
+    attrs1.add(InventoryAttribute("color", 2));
+    manager.addProduct(attrs1, "Widget", 10);
+    List1D<InventoryAttribute> attrs2;
+    attrs2.add(InventoryAttribute("color", 3));
+    attrs2.add(InventoryAttribute("weight", 2.5));
+    manager.addProduct(attrs2, "Gadget", 7);
+    List1D<InventoryAttribute> attrs3;
+    attrs3.add(InventoryAttribute("weigh", 2.5));
+    manager.addProduct(attrs3, "Widget", 4);
+
+    InventoryCompressor<3> compressor(&manager);
+    compressor.buildHuffman();
+    List1D<InventoryAttribute> attrs4;
+    attrs4.add(InventoryAttribute("weight", 2.75));
+    manager.addProduct(attrs4, "Zed#", 1); // bản ghi RAW: truy vấn giải mã đầy đủ
+
+    InventoryManager plain(manager);
+    manager.enableCompressedStorage(&compressor, 4);
+    cout << "same: " << (manager.query("weight", 2.0, 3.0, 0, true).toString() == plain.query("weight", 2.0, 3.0, 0, true).toString()) << endl;
+    cout << manager.query("weight", 2.0, 3.0, 0, true) << endl;
+
+    string key = compressor.encodeAttributeKey("weight");
+    string gadget = compressor.encodeRecord(attrs2, "Gadget");
+    cout << "match: " << compressor.matchAttribute(gadget, key, 2.0, 3.0) << " "
+         << compressor.matchAttribute(gadget, key, 3.0, 4.0) << " "
+         << compressor.matchAttribute(compressor.encodeRecord(attrs3, "Widget"), key, 0.0, 10.0) << " "
+         << compressor.matchAttribute(compressor.encodeRecord(attrs4, "Zed#"), key, 0.0, 10.0) << endl;
+}
+
+void compressor104()
+{
+    expect = "compressed: 1 records: 5 duplicates: 2 rate: 0.4\nsmaller: 1\ndecompressed: 1 duplicates: 2\nCar,1,speed=88,weight=1250.5\nLamp,2\nCar,9,speed=88,weight=1250.5\nCar,4,speed=88,weight=1250.5\nLamp,2\n";
+    const char *inputPath = "dedup_input.csv";
+    const char *archivePath = "dedup_archive.hfsa";
+    const char *plainPath = "dedup_plain.hfsa";
+    const char *outputPath = "dedup_output.csv";
+    {
+        ofstream input(inputPath);
+        input << "Car,1,speed=88,weight=1250.5\n";
+        input << "Lamp,2\n";
+        input << "Car,9,speed=88,weight=1250.5\n";
+        input << "Car,4,speed=88.0,weight=1250.50\n"; // cùng chuỗi productToExactString
+        input << "Lamp,2\n";                          // quá ngắn: mã hoá lại rẻ hơn tham chiếu
+    }
+
+    StreamingCompressor<4> compressor(',', 2);
+    StreamingCompressor<4>::Stats stats;
+    bool ok = compressor.compressFile(inputPath, archivePath, stats);
+    cout << "compressed: " << ok << " records: " << stats.records << " duplicates: " << stats.duplicates
+         << " rate: " << stats.dedupHitRate() << endl;
+
+    StreamingCompressor<4> plain(',', 2);
+    plain.setDedupCapacity(0);
+    plain.compressFile(inputPath, plainPath, stats);
+    ifstream archive(archivePath, ios::binary | ios::ate);
+    ifstream plainArchive(plainPath, ios::binary | ios::ate);
+    cout << "smaller: " << (archive.tellg() < plainArchive.tellg()) << endl;
+    archive.close();
+    plainArchive.close();
+
+    StreamingCompressor<4> decompressor(',', 2);
+    ok = decompressor.decompressFile(archivePath, outputPath, stats);
+    cout << "decompressed: " << ok << " duplicates: " << stats.duplicates << endl;
+    ifstream output(outputPath);
+    string line;
+    while (getline(output, line))
+    {
+        cout << line << endl;
+    }
+    output.close();
+
+    remove(inputPath);
+    remove(archivePath);
+    remove(plainPath);
+    remove(outputPath);
+}
+
+void compressor105()
+{
+    expect = "indexed: 1\n[Drill, Saw]\n[Hammer, Saw]\n[Hammer, Saw]\n[Saw]\nsame: 1\n";
+    InventoryManager manager;
+    manager.setAttributeIndexing(true);
+    List1D<InventoryAttribute> drill;
+    drill.add(InventoryAttribute("weight", 2.0));
+    manager.addProduct(drill, "Drill", 5);
+    List1D<InventoryAttribute> saw;
+    saw.add(InventoryAttribute("weight", 3.0));
+    saw.add(InventoryAttribute("weight", 3.5)); // hai thuộc tính cùng tên trong khoảng: chỉ một kết quả
+    manager.addProduct(saw, "Saw", 2);
+    cout << "indexed: " << manager.isAttributeIndexing() << endl;
+    cout << manager.query("weight", 1.0, 4.0, 0, true) << endl;
+
+    // Chỉ mục đã dựng: thêm, xoá và cập nhật số lượng phải được phản ánh
+    List1D<InventoryAttribute> hammer;
+    hammer.add(InventoryAttribute("weight", 1.5));
+    manager.addProduct(hammer, "Hammer", 1);
+    manager.removeProduct(0);
+    cout << manager.query("weight", 1.0, 4.0, 0, true) << endl;
+    manager.updateQuantity(1, 9);
+    cout << manager.query("weight", 1.0, 4.0, 2, true) << endl;
+    cout << manager.query("weight", 3.5, 3.5, 0, true) << endl;
+
+    InventoryManager scan(manager);
+    scan.setAttributeIndexing(false);
+    cout << "same: " << (scan.query("weight", 0.0, 10.0, 0, false).toString() == manager.query("weight", 0.0, 10.0, 0, false).toString()) << endl;
+}
+
+void compressor106()
+{
+    expect = "[0, 2]\n[]\n[1, 3]\n[0, 2, 3]\nafter dedup: [Bolt, Nut, Bolt] [7, 4, 1]\n[0, 2]\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> small;
+    small.add(InventoryAttribute("size", 1));
+    List1D<InventoryAttribute> large;
+    large.add(InventoryAttribute("size", 2));
+    manager.addProduct(small, "Bolt", 5);
+    manager.addProduct(small, "Nut", 4);
+    manager.addProduct(small, "Bolt", 2);
+    cout << manager.findByName("Bolt") << endl;
+    cout << manager.findByName("Washer") << endl;
+
+    // Chỉ mục đã dựng được cập nhật khi thêm và xoá
+    manager.addProduct(large, "Nut", 3);
+    manager.addProduct(large, "Bolt", 1);
+    cout << manager.findByName("Nut") << endl;
+    manager.removeProduct(3);
+    cout << manager.findByName("Bolt") << endl;
+
+    manager.removeDuplicates();
+    cout << "after dedup: " << manager.getProductNames() << " " << manager.getQuantities() << endl;
+    cout << manager.findByName("Bolt") << endl;
+}
+
+void compressor107()
+{
+    expect = "dedup: [Bolt, Nut, Bolt] [8, 4, 1]\ninsert: 3 [Bolt, Nut, Bolt] [8, 4, 1]\nafter add: 3 [10, 4, 1]\nafter remove: 2 [Nut, Bolt] [4, 6]\n";
+    List1D<InventoryAttribute> small;
+    small.add(InventoryAttribute("size", 1));
+    List1D<InventoryAttribute> large;
+    large.add(InventoryAttribute("size", 2));
+
+    InventoryManager manager;
+    manager.addProduct(small, "Bolt", 5);
+    manager.addProduct(small, "Nut", 4);
+    manager.addProduct(large, "Bolt", 1);
+    manager.addProduct(small, "Bolt", 3);
+    InventoryManager insertMode(manager);
+    manager.removeDuplicates();
+    cout << "dedup: " << manager.getProductNames() << " " << manager.getQuantities() << endl;
+
+    // Bật chế độ gộp khi thêm: các bản trùng sẵn có được gộp ngay
+    insertMode.setDedupeOnInsert(true);
+    cout << "insert: " << insertMode.size() << " " << insertMode.getProductNames() << " " << insertMode.getQuantities() << endl;
+    insertMode.addProduct(small, "Bolt", 2);
+    cout << "after add: " << insertMode.size() << " " << insertMode.getQuantities() << endl;
+    insertMode.removeProduct(0);
+    insertMode.addProduct(large, "Bolt", 5);
+    cout << "after remove: " << insertMode.size() << " " << insertMode.getProductNames() << " " << insertMode.getQuantities() << endl;
+}
+
+void compressor108()
+{
+    expect = "merged: [Bolt, Nut, Bolt, Washer] [7, 5, 1, 3]\nself: [Bolt, Nut, Bolt] [14, 10, 2]\n";
+    List1D<InventoryAttribute> small;
+    small.add(InventoryAttribute("size", 1));
+    List1D<InventoryAttribute> large;
+    large.add(InventoryAttribute("size", 2));
+
+    InventoryManager first;
+    first.addProduct(small, "Bolt", 5);
+    first.addProduct(small, "Nut", 4);
+    first.addProduct(small, "Bolt", 2);
+    InventoryManager second;
+    second.addProduct(small, "Nut", 1);
+    second.addProduct(large, "Bolt", 1);
+    second.addProduct(large, "Washer", 3);
+
+    // Bản trùng trong cùng một kho cũng được gộp, thứ tự theo lần xuất hiện đầu tiên
+    InventoryManager merged = InventoryManager::merge(first, second);
+    cout << "merged: " << merged.getProductNames() << " " << merged.getQuantities() << endl;
+    InventoryManager self = InventoryManager::merge(merged, merged);
+    self.removeProduct(3);
+    cout << "self: " << self.getProductNames() << " " << self.getQuantities() << endl;
+}
+
+void compressor109()
+{
+    expect = "query: [Washer, Nut, Gear, Bolt, Anchor]\npage: [Gear, Bolt]\ntail: [Anchor]\nempty: []\n";
+    InventoryManager manager;
+    string names[] = {"Nut", "Bolt", "Washer", "Anchor", "Gear", "Spring"};
+    for (int i = 0; i < 6; i++)
+    {
+        List1D<InventoryAttribute> attributes;
+        attributes.add(InventoryAttribute("weight", i));
+        manager.addProduct(attributes, names[i], 10);
+    }
+    cout << "query: " << manager.query("weight", 0, 4, 1, false) << endl;
+    // Trang 2 (cỡ 2) theo thứ tự giảm dần, trang cuối thiếu phần tử và trang vượt quá kết quả
+    cout << "page: " << manager.queryPage("weight", 0, 4, 1, false, 2, 2) << endl;
+    cout << "tail: " << manager.queryPage("weight", 0, 4, 1, false, 4, 2) << endl;
+    cout << "empty: " << manager.queryPage("weight", 0, 4, 1, false, 6, 2) << endl;
+}
+
+void compressor110()
+{
+    expect = "columnar: 1 [Bolt, Nut]\nrow: [size: 2, size: 7, color: 1]\nafter: [Nut, Washer] [Washer]\nrows: 0 [size: 2, size: 7, color: 1]\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> bolt;
+    bolt.add(InventoryAttribute("size", 4));
+    List1D<InventoryAttribute> nut;
+    nut.add(InventoryAttribute("size", 2));
+    nut.add(InventoryAttribute("size", 7));
+    nut.add(InventoryAttribute("color", 1));
+    List1D<InventoryAttribute> washer;
+    washer.add(InventoryAttribute("color", 3));
+    manager.addProduct(bolt, "Bolt", 5);
+    manager.addProduct(nut, "Nut", 2);
+    manager.enableColumnarStorage();
+    manager.addProduct(washer, "Washer", 9);
+
+    // Thuộc tính thưa (color) và tên lặp trong một sản phẩm (size) đều nằm trong cột
+    cout << "columnar: " << manager.isColumnarStorage() << " " << manager.query("size", 3, 8, 1, true) << endl;
+    cout << "row: " << manager.getProductAttributes(1) << endl;
+    manager.removeProduct(0);
+    manager.updateQuantity(0, 0);
+    cout << "after: " << manager.query("color", 0, 5, 0, true) << " " << manager.query("color", 0, 5, 1, true) << endl;
+    manager.disableColumnarStorage();
+    cout << "rows: " << manager.isColumnarStorage() << " " << manager.getProductAttributes(0) << endl;
+}
+
+void compressor111()
+{
+    expect = "same: 1 1 1\ndiffer: 0 0\nquery: [Nut]\nunknown: []\n";
+    InventoryAttribute first("weight", 1);
+    InventoryAttribute second(string("weight"), 2);
+    InventoryAttribute other("height", 1);
+    // Cùng tên: cùng mã và cùng bản lưu
+    cout << "same: " << (first.name == second.name) << " " << (first.name.id() == second.name.id())
+         << " " << (&first.name.str() == &second.name.str()) << endl;
+    cout << "differ: " << (first.name == other.name) << " " << (first == InventoryAttribute("weight", 2)) << endl;
+
+    InventoryManager manager;
+    List1D<InventoryAttribute> bolt;
+    bolt.add(other);
+    List1D<InventoryAttribute> nut;
+    nut.add(second);
+    manager.addProduct(bolt, "Bolt", 1);
+    manager.addProduct(nut, "Nut", 1);
+    cout << "query: " << manager.query("weight", 0, 5, 0, true) << endl;
+    cout << "unknown: " << manager.query("never interned", 0, 5, 0, true) << endl;
+}
+
+void compressor112()
+{
+    expect = "added: [Bolt, Nut, Gear, Washer] [1, 2, 3, 4]\nupdated: [1, 20, 3, 40]\nremoved: [Nut] [20]\nrejected: 1 [Nut]\n";
+    InventoryManager manager;
+    List2D<InventoryAttribute> rows;
+    List1D<string> names;
+    List1D<int> quantities;
+    string productNames[] = {"Bolt", "Nut", "Gear", "Washer"};
+    for (int i = 0; i < 4; i++)
+    {
+        List1D<InventoryAttribute> *row = new List1D<InventoryAttribute>();
+        row->add(InventoryAttribute("size", i));
+        rows.addRow(row);
+        names.add(productNames[i]);
+        quantities.add(i + 1);
+    }
+    manager.addProducts(rows, names, quantities);
+    cout << "added: " << manager.getProductNames() << " " << manager.getQuantities() << endl;
+
+    List1D<int> indices;
+    indices.add(3);
+    indices.add(1);
+    List1D<int> values;
+    values.add(40);
+    values.add(20);
+    manager.updateQuantities(indices, values);
+    cout << "updated: " << manager.getQuantities() << endl;
+
+    // Thứ tự tuỳ ý, chỉ số lặp chỉ xoá một lần
+    List1D<int> doomed;
+    doomed.add(3);
+    doomed.add(0);
+    doomed.add(2);
+    doomed.add(0);
+    manager.removeProducts(doomed);
+    cout << "removed: " << manager.getProductNames() << " " << manager.getQuantities() << endl;
+
+    // Chỉ số sai: cả lô bị từ chối, kho không đổi
+    List1D<int> invalid;
+    invalid.add(0);
+    invalid.add(7);
+    try
+    {
+        manager.removeProducts(invalid);
+    }
+    catch (const out_of_range &)
+    {
+        cout << "rejected: " << manager.size() << " " << manager.getProductNames() << endl;
+    }
+}
+
+void compressor113()
+{
+    expect = "snapshot: [Bolt, Nut, Gear] [1, 2, 3]\nlive: [Bolt, Gear, Washer] [10, 3, 4]\nsnapshot query: [Nut, Gear]\ncolumnar: 1 [Bolt, Nut, Gear] [1, 2, 3]\n";
+    InventoryManager manager;
+    string productNames[] = {"Bolt", "Nut", "Gear"};
+    for (int i = 0; i < 3; i++)
+    {
+        List1D<InventoryAttribute> attributes;
+        attributes.add(InventoryAttribute("size", i));
+        manager.addProduct(attributes, productNames[i], i + 1);
+    }
+
+    // Ảnh chụp không đổi khi bản gốc bị sửa
+    InventoryManager frozen = manager.snapshot();
+    manager.updateQuantity(0, 10);
+    manager.removeProduct(1);
+    List1D<InventoryAttribute> washer;
+    washer.add(InventoryAttribute("size", 5));
+    manager.addProduct(washer, "Washer", 4);
+    cout << "snapshot: " << frozen.getProductNames() << " " << frozen.getQuantities() << endl;
+    cout << "live: " << manager.getProductNames() << " " << manager.getQuantities() << endl;
+    cout << "snapshot query: " << frozen.query("size", 1, 2, 0, false) << endl;
+
+    // Ảnh chụp giữ nguyên chế độ lưu theo cột
+    InventoryManager columnar = frozen.snapshot();
+    columnar.enableColumnarStorage();
+    InventoryManager columnarFrozen = columnar.snapshot();
+    columnar.updateQuantity(2, 30);
+    cout << "columnar: " << columnarFrozen.isColumnarStorage() << " " << columnarFrozen.getProductNames() << " "
+         << columnarFrozen.getQuantities() << endl;
+}
+
+void compressor114()
+{
+    expect = "shards: 3 [Bolt, Gear, Nut, Washer, Screw]\nupdated: 4000 4000 4000 4000 4000\nremoved: 3 2 Screw\nquery: [Screw, Gear]\nplain: [Bolt, Gear, Screw] [4000, 4000, 4000]\n";
+    ConcurrentInventoryManager manager(2);
+    string productNames[] = {"Bolt", "Gear", "Nut", "Washer", "Screw"};
+    for (int i = 0; i < 5; i++)
+    {
+        List1D<InventoryAttribute> attributes;
+        attributes.add(InventoryAttribute("size", i));
+        manager.addProduct(attributes, productNames[i], 0);
+    }
+    cout << "shards: " << manager.shardCount() << " " << manager.toInventory().getProductNames() << endl;
+
+    // Bốn luồng cùng cập nhật mọi sản phẩm; lần ghi cuối của mỗi luồng là 4000
+    thread workers[4];
+    for (int t = 0; t < 4; t++)
+    {
+        workers[t] = thread([&manager]()
+                            {
+            for (int round = 1; round <= 1000; round++)
+            {
+                for (int i = 0; i < manager.size(); i++)
+                {
+                    manager.updateQuantity(i, round * 4);
+                }
+            } });
+    }
+    for (int t = 0; t < 4; t++)
+    {
+        workers[t].join();
+    }
+    cout << "updated:";
+    for (int i = 0; i < manager.size(); i++)
+    {
+        cout << " " << manager.getProductQuantity(i);
+    }
+    cout << endl;
+
+    // Xoá sản phẩm ở phân đoạn giữa: chỉ số phía sau lùi lại, phân đoạn rỗng bị bỏ
+    manager.removeProduct(2);
+    manager.removeProduct(2);
+    cout << "removed: " << manager.size() << " " << manager.shardCount() << " " << manager.getProductName(2) << endl;
+    cout << "query: " << manager.query("size", 1, 4, 1, false) << endl;
+    InventoryManager plain = manager.toInventory();
+    cout << "plain: " << plain.getProductNames() << " " << plain.getQuantities() << endl;
+}
+
+void compressor115()
+{
+    expect = "rows: [Gear, Bolt]\nindexed: [Gear, Bolt]\ncolumnar: [Gear, Bolt]\nquantity only: [Bolt, Nut]\nunknown: []\n";
+    InventoryManager manager;
+    string productNames[] = {"Bolt", "Nut", "Gear", "Washer"};
+    double weights[] = {1, 2, 3, 9};
+    double depths[] = {5, 50, 7, 6};
+    int stock[] = {4, 8, 2, 1};
+    for (int i = 0; i < 4; i++)
+    {
+        List1D<InventoryAttribute> attributes;
+        attributes.add(InventoryAttribute("weight", weights[i]));
+        attributes.add(InventoryAttribute("depth", depths[i]));
+        manager.addProduct(attributes, productNames[i], stock[i]);
+    }
+
+    // weight trong [0, 5], depth trong [0, 10] và số lượng >= 2
+    List1D<AttributeRange> ranges;
+    ranges.add(AttributeRange("weight", 0, 5));
+    ranges.add(AttributeRange("depth", 0, 10));
+    cout << "rows: " << manager.query(ranges, 2, false) << endl;
+    manager.setAttributeIndexing(true);
+    cout << "indexed: " << manager.query(ranges, 2, false) << endl;
+    manager.setAttributeIndexing(false);
+    manager.enableColumnarStorage();
+    cout << "columnar: " << manager.query(ranges, 2, false) << endl;
+
+    List1D<AttributeRange> none;
+    cout << "quantity only: " << manager.query(none, 3, true) << endl;
+    ranges.add(AttributeRange("colour", 0, 1));
+    cout << "unknown: " << manager.query(ranges, 0, true) << endl;
+}
+
+void compressor116()
+{
+    expect = "unknown: [] 0\nknown: [Bolt]\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> attributes;
+    attributes.add(InventoryAttribute("size", 1));
+    manager.addProduct(attributes, "Bolt", 1);
+    manager.setAttributeIndexing(true);
+
+    // Truy vấn một tên chưa từng xuất hiện không thêm tên đó vào bảng tên dùng chung
+    int poolSize = AttributeNamePool::instance().size();
+    List1D<string> unknown = manager.query("never-interned-attribute", 0, 10, 0, true);
+    cout << "unknown: " << unknown << " " << AttributeNamePool::instance().size() - poolSize << endl;
+    cout << "known: " << manager.query("size", 0, 10, 0, true) << endl;
+}
+
+void compressor117()
+{
+    expect = "same as trained: 1\ndiffers from bfs: 1\ndecoded: abcdef\n";
+    XArrayList<pair<char, int>> symbolsFreqs;
+    symbolsFreqs.add(make_pair('a', 40));
+    symbolsFreqs.add(make_pair('b', 3));
+    symbolsFreqs.add(make_pair('c', 2));
+    symbolsFreqs.add(make_pair('d', 2));
+    symbolsFreqs.add(make_pair('e', 1));
+    symbolsFreqs.add(make_pair('f', 1));
+    HuffmanTree<2> trained;
+    trained.build(symbolsFreqs);
+    trained.setLayoutOrder(HuffmanTree<2>::HOT_FIRST);
+    XArrayList<int> trainedHot;
+    trained.flattenStates(trainedHot);
+
+    // Mô hình nạp lại không có tần số: trọng số suy từ độ sâu lá phải cho cùng thứ tự HOT_FIRST
+    string model;
+    trained.serialize(model);
+    HuffmanTree<2> loaded;
+    size_t pos = 0;
+    loaded.deserialize(model, pos, model.size());
+    XArrayList<int> loadedBfs, loadedHot;
+    loaded.flattenStates(loadedBfs);
+    loaded.setLayoutOrder(HuffmanTree<2>::HOT_FIRST);
+    loaded.flattenStates(loadedHot);
+
+    bool same = loadedHot.size() == trainedHot.size();
+    bool differs = false;
+    for (int i = 0; i < loadedHot.size(); i++)
+    {
+        same = same && i < trainedHot.size() && loadedHot.get(i) == trainedHot.get(i);
+        differs = differs || loadedHot.get(i) != loadedBfs.get(i);
+    }
+    cout << "same as trained: " << same << endl;
+    cout << "differs from bfs: " << differs << endl;
+
+    xMap<char, string> table([](char &key, int capacity)
+                             { return (int)(unsigned char)key % capacity; });
+    trained.generateCodes(table);
+    string code;
+    string text = "abcdef";
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        code += table.get(text[i]);
+    }
+    cout << "decoded: " << loaded.decode(code) << endl;
+}
+
+void compressor118()
+{
+    expect = "products: 3\n[Multi\nLine Saw] [blade\\nsize: 5]\n[Back\\slash] [width: 2]\n[Plain] [depth: 7]\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> sawAttrs;
+    sawAttrs.add(InventoryAttribute("blade\nsize", 5.0));
+    manager.addProduct(sawAttrs, "Multi\nLine Saw", 1);
+    List1D<InventoryAttribute> slashAttrs;
+    slashAttrs.add(InventoryAttribute("width", 2.0));
+    manager.addProduct(slashAttrs, "Back\\slash", 2);
+    List1D<InventoryAttribute> plainAttrs;
+    plainAttrs.add(InventoryAttribute("depth", 7.0));
+    manager.addProduct(plainAttrs, "Plain", 3);
+
+    // Ký tự xuống dòng trong tên không được tách sản phẩm khi giải nén
+    InventoryCompressor<3> compressor(&manager);
+    compressor.setBlockSize(16);
+    string archive = compressor.compressBlockSorted();
+    List2D<InventoryAttribute> attributesOutput;
+    List1D<string> namesOutput;
+    compressor.decompressBlockSorted(archive, attributesOutput, namesOutput);
+    cout << "products: " << namesOutput.size() << endl;
+    for (int i = 0; i < namesOutput.size(); i++)
+    {
+        List1D<InventoryAttribute> attributes = attributesOutput.getRow(i);
+        InventoryAttribute attribute = attributes.get(0);
+        string attributeName = attribute.name.str();
+        size_t newline = attributeName.find('\n');
+        if (newline != string::npos)
+            attributeName.replace(newline, 1, "\\n");
+        cout << "[" << namesOutput.get(i) << "] [" << attributeName << ": " << attribute.value << "]" << endl;
+    }
+}
+
+void compressor119()
+{
+    expect = "decompressed: 1\nCar,1,w=1e-07,h=123.4567891\nPen,3,len=0.1,wt=2.5\nexact: 1\n";
+    const char *inputPath = "exact_input.csv";
+    const char *archivePath = "exact_archive.hfsa";
+    const char *outputPath = "exact_output.csv";
+    {
+        ofstream input(inputPath);
+        input << "Car,1,w=0.0000001,h=123.4567891\n";
+        input << "Pen,3,len=0.1,wt=2.5\n";
+    }
+
+    // Giá trị cần hơn 6 chữ số thập phân vẫn được giải nén đúng
+    StreamingCompressor<4> compressor(',', 2);
+    StreamingCompressor<4>::Stats stats;
+    compressor.compressFile(inputPath, archivePath, stats);
+    StreamingCompressor<4> decompressor(',', 2);
+    bool ok = decompressor.decompressFile(archivePath, outputPath, stats);
+    cout << "decompressed: " << ok << endl;
+    ifstream output(outputPath);
+    string line;
+    bool exact = true;
+    while (getline(output, line))
+    {
+        cout << line << endl;
+        string name;
+        int quantity = 0;
+        List1D<InventoryAttribute> attributes;
+        parseInventoryRecord(line, ',', name, quantity, attributes);
+        if (name == "Car")
+            exact = exact && attributes.get(0).value == 0.0000001 && attributes.get(1).value == 123.4567891;
+    }
+    cout << "exact: " << exact << endl;
+    output.close();
+
+    remove(inputPath);
+    remove(archivePath);
+    remove(outputPath);
+}
+
+void compressor120()
+{
+    expect = "Car 1e-07 123.4567891\nBig 1e+300\nquery: [Car]\nplain: 1e-07 123.4567891 1e+300\n";
+    InventoryManager manager;
+    List1D<InventoryAttribute> carAttrs;
+    carAttrs.add(InventoryAttribute("w", 0.0000001));
+    carAttrs.add(InventoryAttribute("h", 123.4567891));
+    manager.addProduct(carAttrs, "Car", 1);
+    List1D<InventoryAttribute> boltAttrs;
+    boltAttrs.add(InventoryAttribute("len", 2.5));
+    manager.addProduct(boltAttrs, "Bolt-M8", 2); // "-" có mã nên "1e-07" vẫn được đóng gói
+
+    // Giá trị cần hơn 6 chữ số thập phân không bị làm tròn khi lưu nén, kể cả bản ghi RAW ("+" không có mã)
+    InventoryCompressor<4> compressor(&manager);
+    compressor.buildHuffman();
+    manager.enableCompressedStorage(&compressor, 1);
+    List1D<InventoryAttribute> bigAttrs;
+    bigAttrs.add(InventoryAttribute("w", 1e300));
+    manager.addProduct(bigAttrs, "Big", 3);
+    List1D<InventoryAttribute> car = manager.getProductAttributes(0);
+    cout << manager.getProductName(0) << " " << formatExactValue(car.get(0).value) << " "
+         << formatExactValue(car.get(1).value) << endl;
+    cout << manager.getProductName(2) << " " << formatExactValue(manager.getProductAttributes(2).get(0).value) << endl;
+    cout << "query: " << manager.query("w", 1e-8, 1e-6, 0, true) << endl;
+
+    manager.disableCompressedStorage();
+    car = manager.getProductAttributes(0);
+    cout << "plain: " << formatExactValue(car.get(0).value) << " " << formatExactValue(car.get(1).value) << " "
+         << formatExactValue(manager.getProductAttributes(2).get(0).value) << endl;
+}
+
+void compressor121()
+{
+    expect = "readers: 3 same: 1\n";
+    InventoryManager manager;
+    for (int i = 0; i < 60; i++)
+    {
+        List1D<InventoryAttribute> attrs;
+        attrs.add(InventoryAttribute("weight", i % 10));
+        manager.addProduct(attrs, "Part" + to_string(i), i);
+    }
+    string expected = manager.query("weight", 2.0, 3.0, 0, true).toString();
+    InventoryCompressor<4> compressor(&manager);
+    compressor.buildHuffman();
+    manager.enableCompressedStorage(&compressor, 4);
+
+    // Mỗi luồng đọc một bản chụp riêng; các bản chụp dùng chung codec nên đường giải mã chỉ được đọc bảng
+    InventoryManager snapshots[3] = {manager.snapshot(), manager.snapshot(), manager.snapshot()};
+    string results[3];
+    thread readers[3];
+    for (int r = 0; r < 3; r++)
+    {
+        readers[r] = thread([&snapshots, &results, r]()
+                            {
+            results[r] = snapshots[r].query("weight", 2.0, 3.0, 0, true).toString();
+            snapshots[r].getProductAttributes(r); });
+    }
+    bool same = true;
+    for (int r = 0; r < 3; r++)
+    {
+        readers[r].join();
+        same = same && results[r] == expected;
+    }
+    cout << "readers: 3 same: " << same << endl;
+}
+
+void compressor122()
+{
+    expect = "products: 74 shards: 13 bounded: 1 same: 1\n";
+    ConcurrentInventoryManager manager(8);
+    InventoryManager plain;
+    for (int i = 0; i < 200; i++)
+    {
+        List1D<InventoryAttribute> attributes;
+        attributes.add(InventoryAttribute("size", i));
+        manager.addProduct(attributes, "Part" + to_string(i), i);
+        plain.addProduct(attributes, "Part" + to_string(i), i);
+    }
+
+    // Xoá rải rác khắp kho: các phân đoạn thiếu được gộp với phân đoạn kề thay vì chỉ bỏ phân đoạn rỗng
+    bool bounded = true;
+    for (int step = 0; manager.size() > 74; step++)
+    {
+        int index = (step * 37) % manager.size();
+        manager.removeProduct(index);
+        plain.removeProduct(index);
+        bounded = bounded && manager.shardCount() <= 2 * manager.size() / 8 + 1;
+    }
+    cout << "products: " << manager.size() << " shards: " << manager.shardCount() << " bounded: " << bounded
+         << " same: " << (manager.toInventory().toString() == plain.toString()) << endl;
+}
+
+void compressor123()
+{
+    expect = "products: 4 same: 1\n";
+    // Tên nhị phân dùng đủ 256 giá trị byte (trừ ':' ngăn cách tên): khối bị cắt sớm khi bảng chữ cái đầy
+    InventoryManager manager;
+    for (int p = 0; p < 4; p++)
+    {
+        string name;
+        for (int b = p * 64; b < (p + 1) * 64; b++)
+        {
+            if (b != ':')
+                name += (char)b;
+        }
+        List1D<InventoryAttribute> attributes;
+        attributes.add(InventoryAttribute("size", p));
+        manager.addProduct(attributes, name, p + 1);
+    }
+
+    InventoryCompressor<4> compressor(&manager);
+    string archive = compressor.compressBlockSorted();
+    List2D<InventoryAttribute> attributesOutput;
+    List1D<string> namesOutput;
+    compressor.decompressBlockSorted(archive, attributesOutput, namesOutput);
+    bool same = namesOutput.size() == manager.size();
+    for (int i = 0; same && i < namesOutput.size(); i++)
+    {
+        same = namesOutput.get(i) == manager.getProductName(i) &&
+               attributesOutput.getRow(i).toString() == manager.getProductAttributes(i).toString();
+    }
+    cout << "products: " << namesOutput.size() << " same: " << same << endl;
+}
+
+void compressor124()
+{
+    expect = "h 1 0 h height: 2 same: 1\n";
+    // Mã viết cho `string name` vẫn dùng được: gán chuỗi C, length(), c_str(), empty(), nối chuỗi
+    InventoryAttribute attr("width", 2);
+    attr.name = "h";
+    string copy = attr.name;
+    cout << attr.name.c_str() << " " << attr.name.length() << " " << attr.name.empty() << " " << copy;
+    attr.name = attr.name + "eight";
+    InventoryAttribute other(string("height"), 2);
+    cout << " " << attr.name + ": " << attr.value << " same: " << (attr == other && attr.name == "height") << endl;
+}
+
+void compressor125()
+{
+    expect = "frozen: 1 1 1 -0 1 1\nlive: 1 77 2 -0 1 2001\nqueries: 250 251\n";
+    // Kho theo cột nhiều khối: ghi sau snapshot() chỉ tách các khối bị sửa, ảnh chụp vẫn giữ dữ liệu cũ
+    InventoryManager manager;
+    manager.enableColumnarStorage();
+    for (int i = 0; i < 2000; i++)
+    {
+        List1D<InventoryAttribute> attributes;
+        attributes.add(InventoryAttribute("size", i % 3 == 0 ? -0.0 : 0.0));
+        if (i % 8 == 0)
+            attributes.add(InventoryAttribute("weight", i));
+        manager.addProduct(attributes, "P" + to_string(i), 1);
+    }
+
+    InventoryManager frozen = manager.snapshot();
+    manager.updateQuantity(700, 77);
+    manager.removeProduct(2);
+    List1D<InventoryAttribute> extra;
+    extra.add(InventoryAttribute("weight", 5));
+    manager.addProduct(extra, "Extra", 2001);
+
+    cout << "frozen: " << frozen.size() - 1999 << " " << frozen.getProductQuantity(699) << " "
+         << frozen.getProductQuantity(700) << " " << frozen.getProductAttributes(3).get(0).value << " "
+         << frozen.getProductAttributes(1999).size() << " " << frozen.getProductQuantity(1999) << endl;
+    cout << "live: " << manager.size() - 1999 << " " << manager.getProductQuantity(699) << " "
+         << manager.getProductAttributes(0).size() << " " << manager.getProductAttributes(2).get(0).value << " "
+         << manager.getProductAttributes(1998).size() << " " << manager.getProductQuantity(1999) << endl;
+    cout << "queries: " << frozen.query("weight", 0, 2000, 1, true).size() << " "
+         << manager.query("weight", 0, 2000, 1, true).size() << endl;
+}
+
+void compressor126()
+{
+    expect = "rows: [] []\nindexed: [] [] []\ncolumnar: [] []\nfinite: [P3, P4, P5]\n";
+    // Biên NaN không khớp sản phẩm nào trên mọi đường truy vấn (quét hàng, chỉ mục phụ, cột, bộ lập kế hoạch)
+    InventoryManager manager;
+    for (int i = 0; i < 12; i++)
+    {
+        List1D<InventoryAttribute> attributes;
+        attributes.add(InventoryAttribute("v", i));
+        manager.addProduct(attributes, "P" + to_string(i), 1);
+    }
+    List1D<AttributeRange> ranges;
+    ranges.add(AttributeRange("v", 3, 5));
+    ranges.add(AttributeRange("v", NAN, 5));
+
+    cout << "rows: " << manager.query("v", NAN, 5, 0, true) << " " << manager.query(ranges, 0, true) << endl;
+    manager.setAttributeIndexing(true);
+    cout << "indexed: " << manager.query("v", NAN, 5, 0, true) << " " << manager.query("v", 0, NAN, 0, true) << " "
+         << manager.query(ranges, 0, true) << endl;
+    manager.setAttributeIndexing(false);
+    manager.enableColumnarStorage();
+    cout << "columnar: " << manager.query("v", NAN, 5, 0, true) << " " << manager.query(ranges, 0, true) << endl;
+    ranges.removeAt(1);
+    manager.setAttributeIndexing(true);
+    cout << "finite: " << manager.query(ranges, 0, true) << endl;
+}
+
 void (*func_ptr[])() = {
     hash001,
     hash002,
@@ -1733,6 +2887,42 @@ void (*func_ptr[])() = {
     compressor088,
     compressor089,
     // compressor090,
+    compressor091,
+    compressor092,
+    compressor093,
+    compressor094,
+    compressor095,
+    compressor096,
+    compressor097,
+    compressor098,
+    compressor099,
+    compressor100,
+    compressor101,
+    compressor102,
+    compressor103,
+    compressor104,
+    compressor105,
+    compressor106,
+    compressor107,
+    compressor108,
+    compressor109,
+    compressor110,
+    compressor111,
+    compressor112,
+    compressor113,
+    compressor114,
+    compressor115,
+    compressor116,
+    compressor117,
+    compressor118,
+    compressor119,
+    compressor120,
+    compressor121,
+    compressor122,
+    compressor123,
+    compressor124,
+    compressor125,
+    compressor126,
 };
 
 bool run(int func_idx)